@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Способ выделения больших блоков (от HUGE_PAGE_SIZE байт) у AlignedAllocator
+enum class HugePages {
+    // Обычные страницы
+    NONE,
+    // Блок выравнивается по 2 МБ и помечается madvise(MADV_HUGEPAGE) для transparent huge pages
+    TRANSPARENT,
+    // Блок выделяется через mmap(MAP_HUGETLB) из зарезервированных huge pages,
+    // а если их нет, то как при TRANSPARENT
+    EXPLICIT,
+};
+
+inline constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+// Аллокатор, выравнивающий блоки по Alignment байт, например по кэш-линии или для загрузок AVX-512.
+// Большие блоки при Pages != HugePages::NONE размещаются на huge pages, что снижает промахи TLB
+template <typename T, size_t Alignment = 64, HugePages Pages = HugePages::NONE>
+class AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+    static_assert(Alignment <= HUGE_PAGE_SIZE, "Alignment must not exceed the huge page size");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, Pages>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, Pages>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = n * sizeof(T);
+        if (IsHuge(bytes)) {
+            return static_cast<T*>(MapHuge(bytes));
+        }
+        return static_cast<T*>(::operator new(bytes, std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsHuge(bytes)) {
+            UnmapHuge(ptr, bytes);
+        } else {
+            ::operator delete(ptr, bytes, std::align_val_t(Alignment));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment, Pages>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment, Pages>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t HugeRound(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+#if defined(__linux__)
+    static bool IsHuge(size_t bytes) noexcept {
+        return Pages != HugePages::NONE && bytes >= HUGE_PAGE_SIZE;
+    }
+
+    static void* MapHuge(size_t bytes) {
+        const size_t size = HugeRound(bytes);
+        if constexpr (Pages == HugePages::EXPLICIT) {
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (ptr != MAP_FAILED) {
+                return ptr;
+            }
+        }
+        // Отображаем с запасом и обрезаем края, чтобы начало блока пришлось на границу 2 МБ
+        void* raw = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const auto raw_address = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t address = (raw_address + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if (address != raw_address) {
+            munmap(raw, address - raw_address);
+        }
+        munmap(reinterpret_cast<void*>(address + size), raw_address + HUGE_PAGE_SIZE - address);
+        void* ptr = reinterpret_cast<void*>(address);
+        madvise(ptr, size, MADV_HUGEPAGE);
+        return ptr;
+    }
+
+    static void UnmapHuge(void* ptr, size_t bytes) noexcept {
+        munmap(ptr, HugeRound(bytes));
+    }
+#else
+    // Без mmap huge pages недоступны, и все блоки выделяются через operator new
+    static bool IsHuge(size_t /*bytes*/) noexcept {
+        return false;
+    }
+
+    static void* MapHuge(size_t /*bytes*/) {
+        throw std::bad_alloc();
+    }
+
+    static void UnmapHuge(void* /*ptr*/, size_t /*bytes*/) noexcept {
+    }
+#endif
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Монотонная арена: память выдаётся сдвигом указателя по крупным блокам и освобождается
+// только вся сразу вызовом Reset или в деструкторе. Блок, выделенный последним, можно
+// увеличить на месте, пока за ним ничего не выделено. Арена не потокобезопасна:
+// каждому потоку — своя, см. ThreadArena
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = size_t(64) << 10;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) noexcept
+        : block_size_(block_size)
+    {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        Release(nullptr);
+    }
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        if (bytes > size_t(-1) / 4) {
+            throw std::bad_alloc();
+        }
+        char* ptr = Align(top_, alignment);
+        // Выравнивание может сдвинуть указатель за конец блока
+        if (ptr == nullptr || ptr > end_ || bytes > static_cast<size_t>(end_ - ptr)) {
+            AddBlock(bytes + alignment);
+            ptr = Align(top_, alignment);
+        }
+        top_ = ptr + bytes;
+        return ptr;
+    }
+
+    // Увеличивает последний выделенный блок ptr с old_bytes до new_bytes, если за ним свободно
+    bool Expand(void* ptr, size_t old_bytes, size_t new_bytes) noexcept {
+        char* block = static_cast<char*>(ptr);
+        if (block + old_bytes != top_ || new_bytes > static_cast<size_t>(end_ - block)) {
+            return false;
+        }
+        top_ = block + new_bytes;
+        return true;
+    }
+
+    // Освобождает всю выданную память. Самый большой блок остаётся для повторного использования
+    void Reset() noexcept {
+        Release(head_);
+        if (head_ != nullptr) {
+            head_->prev = nullptr;
+            top_ = head_->Data();
+            end_ = reinterpret_cast<char*>(head_) + head_->size;
+        }
+    }
+
+    // Объём памяти, полученной ареной от системы
+    size_t BytesReserved() const noexcept {
+        size_t bytes = 0;
+        for (const Block* block = head_; block != nullptr; block = block->prev) {
+            bytes += block->size;
+        }
+        return bytes;
+    }
+
+private:
+    struct Block {
+        Block* prev;
+        size_t size;
+
+        char* Data() noexcept {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    size_t block_size_;
+    Block* head_ = nullptr;
+    char* top_ = nullptr;
+    char* end_ = nullptr;
+
+    static char* Align(char* ptr, size_t alignment) noexcept {
+        if (ptr == nullptr) {
+            return nullptr;
+        }
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        return ptr + ((alignment - address % alignment) % alignment);
+    }
+
+    // Следующий блок не меньше запрошенного и вдвое больше предыдущего,
+    // чтобы число блоков росло логарифмически
+    void AddBlock(size_t min_bytes) {
+        size_t size = std::max(block_size_, min_bytes + sizeof(Block));
+        if (head_ != nullptr) {
+            size = std::max(size, head_->size * 2);
+        }
+        void* memory = std::malloc(size);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        head_ = new (memory) Block{head_, size};
+        top_ = head_->Data();
+        end_ = static_cast<char*>(memory) + size;
+    }
+
+    // Освобождает все блоки, кроме keep
+    void Release(Block* keep) noexcept {
+        for (Block* block = head_; block != nullptr;) {
+            Block* prev = block->prev;
+            if (block != keep) {
+                std::free(block);
+            }
+            block = prev;
+        }
+        head_ = keep;
+        top_ = end_ = nullptr;
+    }
+};
+
+// Арена текущего потока
+inline Arena& ThreadArena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+// Аллокатор поверх арены; по умолчанию использует арену текущего потока.
+// deallocate ничего не делает, а последний выделенный блок растёт на месте через expand
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept
+        : arena_(&ThreadArena())
+    {
+    }
+
+    explicit ArenaAllocator(Arena& arena) noexcept
+        : arena_(&arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(&other.GetArena())
+    {
+    }
+
+    T* allocate(size_t n) {
+        if (n > size_t(-1) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* /*ptr*/, size_t /*n*/) noexcept {
+    }
+
+    bool expand(T* ptr, size_t old_n, size_t new_n) noexcept {
+        return new_n <= size_t(-1) / sizeof(T) && arena_->Expand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    Arena& GetArena() const noexcept {
+        return *arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == &other.GetArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    Arena* arena_;
+};
+
+// Вектор для временных данных в арене текущего потока.
+// Вектор не должен использоваться после Reset своей арены
+template <typename T, typename Growth = DoublingGrowth>
+using ArenaVector = Vector<T, ArenaAllocator<T>, Growth>;
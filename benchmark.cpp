@@ -0,0 +1,786 @@
+// Бенчмарки Vector в сравнении с std::vector.
+//
+// Сборка и запуск:
+//     g++ -std=c++17 -O2 -DNDEBUG benchmark.cpp -o benchmark
+//     ./benchmark [--max-size=N] [--min-time=SECONDS] [--filter=SUBSTRING] [--perf] [--json=PATH]
+//
+// Для каждого сочетания операции, контейнера, типа элемента и размера (степени 10 от 1 до
+// --max-size, по умолчанию 10^6) выводится время на операцию, число выделений памяти за
+// один прогон и пиковый RSS процесса во время прогонов. Операцией считается обработка одного
+// элемента для PushBack, EmplaceBack, Reserve, CopyAssign и Iterate и один вызов
+// для остальных случаев.
+//
+// С --perf на Linux в измеряемых участках дополнительно считаются счётчики perf_event_open
+// (такты, инструкции, промахи L1D, LLC и dTLB, страничные отказы) в пересчёте на операцию.
+// Нужен доступ к perf: kernel.perf_event_paranoid <= 2 для счётчиков пользовательского режима.
+// Недоступные счётчики выводятся как "-". С --json=PATH результаты также записываются
+// в файл JSON, который удобно сравнивать между коммитами
+
+#include "vector.h"
+#include "test_objects.h"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+size_t num_allocations = 0;
+size_t num_allocated_bytes = 0;
+
+}  // namespace
+
+#if defined(__GNUC__)
+// Без встраивания GCC видит в delete вызов free для памяти из operator new и ложно предупреждает
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#else
+#define BENCHMARK_NOINLINE
+#endif
+
+// Глобальные operator new/delete подменяются, чтобы считать выделения памяти контейнерами
+BENCHMARK_NOINLINE void* operator new(size_t size) {
+    ++num_allocations;
+    num_allocated_bytes += size;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+BENCHMARK_NOINLINE void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+BENCHMARK_NOINLINE void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+// Не даёт компилятору выбросить вычисления, результат которых не используется
+template <typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Pod64 {
+    uint64_t words[8];
+};
+
+// Значения элементов, которыми заполняются контейнеры
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, int>) {
+        return static_cast<int>(i);
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        Pod64 pod{};
+        pod.words[0] = i;
+        return pod;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        // Строка длиннее буфера SSO, чтобы копирование выделяло память
+        return std::string(32, static_cast<char>('a' + i % 26));
+    } else if constexpr (std::is_same_v<T, Obj>) {
+        return Obj(static_cast<int>(i));
+    } else {
+        return T();
+    }
+}
+
+// Значение, которое читается из элемента при обходе
+template <typename T>
+uint64_t Touch(const T& value) {
+    if constexpr (std::is_same_v<T, int>) {
+        return static_cast<uint64_t>(value);
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        return value.words[0];
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    } else if constexpr (std::is_same_v<T, Obj>) {
+        return static_cast<uint64_t>(value.id);
+    } else {
+        return 1;
+    }
+}
+
+// Единый интерфейс к std::vector и Vector
+template <typename T>
+struct StdVectorTraits {
+    using Container = std::vector<T>;
+    static constexpr const char* NAME = "std::vector";
+
+    static void PushBack(Container& c, const T& value) {
+        c.push_back(value);
+    }
+    static void EmplaceBack(Container& c, T&& value) {
+        c.emplace_back(std::move(value));
+    }
+    static void Reserve(Container& c, size_t capacity) {
+        c.reserve(capacity);
+    }
+    static void Insert(Container& c, size_t pos, T&& value) {
+        c.insert(c.begin() + pos, std::move(value));
+    }
+    static void Insert(Container& c, size_t pos, const T& value) {
+        c.insert(c.begin() + pos, value);
+    }
+    template <typename... Args>
+    static void Emplace(Container& c, size_t pos, Args&&... args) {
+        c.emplace(c.begin() + pos, std::forward<Args>(args)...);
+    }
+    static void Erase(Container& c, size_t pos) {
+        c.erase(c.begin() + pos);
+    }
+    static size_t Size(const Container& c) {
+        return c.size();
+    }
+};
+
+template <typename T>
+struct VectorTraits {
+    using Container = Vector<T>;
+    static constexpr const char* NAME = "Vector";
+
+    static void PushBack(Container& c, const T& value) {
+        c.PushBack(value);
+    }
+    static void EmplaceBack(Container& c, T&& value) {
+        c.EmplaceBack(std::move(value));
+    }
+    static void Reserve(Container& c, size_t capacity) {
+        c.Reserve(capacity);
+    }
+    static void Insert(Container& c, size_t pos, T&& value) {
+        c.Insert(c.cbegin() + pos, std::move(value));
+    }
+    static void Insert(Container& c, size_t pos, const T& value) {
+        c.Insert(c.cbegin() + pos, value);
+    }
+    template <typename... Args>
+    static void Emplace(Container& c, size_t pos, Args&&... args) {
+        c.Emplace(c.cbegin() + pos, std::forward<Args>(args)...);
+    }
+    static void Erase(Container& c, size_t pos) {
+        c.Erase(c.cbegin() + pos);
+    }
+    static size_t Size(const Container& c) {
+        return c.Size();
+    }
+};
+
+// Счётчики, которые собираются с --perf
+enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    DTLB_MISSES,
+    PAGE_FAULTS,
+    NUM_COUNTERS,
+};
+
+// Имена счётчиков в JSON и заголовке таблицы
+const std::array<const char*, NUM_COUNTERS> COUNTER_NAMES = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "page_faults",
+};
+
+// Значения счётчиков; отрицательное значение означает, что счётчик недоступен
+using CounterValues = std::array<double, NUM_COUNTERS>;
+
+// Счётчики perf_event_open вызывающего потока, только пользовательский режим. Каждый счётчик
+// открывается отдельно, а не группой: если процессор не может считать все сразу, ядро
+// чередует их, и значения масштабируются по доле времени, когда счётчик работал
+class PerfCounters {
+public:
+    PerfCounters() {
+        fds_.fill(-1);
+#if defined(__linux__)
+        const auto cache = [](uint64_t cache_id, uint64_t result) {
+            return cache_id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+        };
+        const std::array<std::pair<uint32_t, uint64_t>, NUM_COUNTERS> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        }};
+        for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0UL));
+            if (fds_[i] < 0 && error_.empty()) {
+                error_ = std::string(COUNTER_NAMES[i]) + ": " + std::strerror(errno);
+            }
+        }
+#else
+        error_ = "perf_event_open is only available on Linux";
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    // Причина, по которой первый недоступный счётчик не открылся; пусто, если открылись все
+    const std::string& Error() const {
+        return error_;
+    }
+
+    void Reset() {
+        Control(RESET);
+    }
+
+    void Enable() {
+        Control(ENABLE);
+    }
+
+    void Disable() {
+        Control(DISABLE);
+    }
+
+    // Значения с момента Reset за время между Enable и Disable
+    CounterValues Read() const {
+        CounterValues values;
+        values.fill(-1);
+#if defined(__linux__)
+        for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+            uint64_t data[3] = {};  // значение, время включения, время работы
+            if (fds_[i] >= 0 && read(fds_[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data))) {
+                values[i] = data[2] == 0 ? 0.0 : static_cast<double>(data[0]) * static_cast<double>(data[1])
+                    / static_cast<double>(data[2]);
+            }
+        }
+#endif
+        return values;
+    }
+
+private:
+    enum Request {
+        RESET,
+        ENABLE,
+        DISABLE,
+    };
+
+    void Control([[maybe_unused]] Request request) {
+#if defined(__linux__)
+        static const unsigned long REQUESTS[] = {PERF_EVENT_IOC_RESET, PERF_EVENT_IOC_ENABLE, PERF_EVENT_IOC_DISABLE};
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, REQUESTS[request], 0);
+            }
+        }
+#endif
+    }
+
+    std::array<int, NUM_COUNTERS> fds_;
+    std::string error_;
+};
+
+// Измеряет время и выделения памяти только внутри отмеченных участков прогона.
+// Если заданы счётчики perf, они работают только в этих же участках
+class Timer {
+public:
+    explicit Timer(PerfCounters* counters = nullptr)
+        : counters_(counters)
+    {
+    }
+
+    void Start() {
+        allocations_at_start_ = num_allocations;
+        if (counters_ != nullptr) {
+            counters_->Enable();
+        }
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    void Stop() {
+        const auto stop = std::chrono::steady_clock::now();
+        if (counters_ != nullptr) {
+            counters_->Disable();
+        }
+        elapsed_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start_).count();
+        allocations_ += num_allocations - allocations_at_start_;
+    }
+
+    int64_t ElapsedNs() const {
+        return elapsed_ns_;
+    }
+
+    size_t Allocations() const {
+        return allocations_;
+    }
+
+private:
+    PerfCounters* counters_;
+    std::chrono::steady_clock::time_point start_;
+    int64_t elapsed_ns_ = 0;
+    size_t allocations_at_start_ = 0;
+    size_t allocations_ = 0;
+};
+
+// Число вызовов для операций вставки и удаления: каждая стоит O(N), поэтому на больших
+// размерах их меньше, чтобы один прогон оставался ограниченным по времени
+size_t NumPointOps(size_t size) {
+    return std::max<size_t>(1, std::min<size_t>(1000, 100'000'000 / std::max<size_t>(size, 1)));
+}
+
+template <typename Traits, typename T>
+typename Traits::Container MakeFilled(size_t size) {
+    typename Traits::Container c;
+    Traits::Reserve(c, size);
+    for (size_t i = 0; i < size; ++i) {
+        Traits::EmplaceBack(c, MakeValue<T>(i));
+    }
+    return c;
+}
+
+// Каждый бенчмарк выполняет один прогон и возвращает число операций в нём
+
+template <typename Traits, typename T>
+size_t BenchPushBack(size_t size, Timer& timer) {
+    const T value = MakeValue<T>(size);
+    typename Traits::Container c;
+    timer.Start();
+    for (size_t i = 0; i < size; ++i) {
+        Traits::PushBack(c, value);
+    }
+    DoNotOptimize(c);
+    timer.Stop();
+    return size;
+}
+
+template <typename Traits, typename T>
+size_t BenchEmplaceBack(size_t size, Timer& timer) {
+    typename Traits::Container c;
+    timer.Start();
+    for (size_t i = 0; i < size; ++i) {
+        Traits::EmplaceBack(c, MakeValue<T>(i));
+    }
+    DoNotOptimize(c);
+    timer.Stop();
+    return size;
+}
+
+template <typename Traits, typename T>
+size_t BenchReserve(size_t size, Timer& timer) {
+    auto c = MakeFilled<Traits, T>(size);
+    timer.Start();
+    Traits::Reserve(c, size * 2);
+    DoNotOptimize(c);
+    timer.Stop();
+    return size;
+}
+
+template <typename Traits, typename T, int Where>
+size_t BenchInsert(size_t size, Timer& timer) {
+    auto c = MakeFilled<Traits, T>(size);
+    const size_t num_ops = NumPointOps(size);
+    // Вместимость заранее увеличена, чтобы измерялся сдвиг хвоста, а не рост
+    Traits::Reserve(c, size + num_ops);
+    timer.Start();
+    for (size_t i = 0; i < num_ops; ++i) {
+        const size_t current_size = Traits::Size(c);
+        const size_t pos = Where == 0 ? 0 : Where == 1 ? current_size / 2 : current_size;
+        Traits::Insert(c, pos, MakeValue<T>(i));
+    }
+    DoNotOptimize(c);
+    timer.Stop();
+    return num_ops;
+}
+
+// Создаёт элемент в позиции pos из аргументов конструктора, а не из готового значения
+template <typename Traits, typename T>
+void EmplaceValue(typename Traits::Container& c, size_t pos, size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        Traits::Emplace(c, pos, size_t(32), static_cast<char>('a' + i % 26));
+    } else if constexpr (std::is_same_v<T, Obj>) {
+        Traits::Emplace(c, pos, static_cast<int>(i));
+    } else {
+        Traits::Emplace(c, pos, MakeValue<T>(i));
+    }
+}
+
+template <typename Traits, typename T, int Where>
+size_t BenchEmplace(size_t size, Timer& timer) {
+    auto c = MakeFilled<Traits, T>(size);
+    const size_t num_ops = NumPointOps(size);
+    Traits::Reserve(c, size + num_ops);
+    timer.Start();
+    for (size_t i = 0; i < num_ops; ++i) {
+        const size_t current_size = Traits::Size(c);
+        const size_t pos = Where == 0 ? 0 : Where == 1 ? current_size / 2 : current_size;
+        EmplaceValue<Traits, T>(c, pos, i);
+    }
+    DoNotOptimize(c);
+    timer.Stop();
+    return num_ops;
+}
+
+// Вставка копии элемента самого контейнера, лежащего в сдвигаемом хвосте
+template <typename Traits, typename T>
+size_t BenchInsertCopy(size_t size, Timer& timer) {
+    auto c = MakeFilled<Traits, T>(size);
+    const size_t num_ops = NumPointOps(size);
+    Traits::Reserve(c, size + num_ops);
+    timer.Start();
+    for (size_t i = 0; i < num_ops; ++i) {
+        const size_t current_size = Traits::Size(c);
+        Traits::Insert(c, current_size / 2, c[current_size - 1]);
+    }
+    DoNotOptimize(c);
+    timer.Stop();
+    return num_ops;
+}
+
+template <typename Traits, typename T, int Where>
+size_t BenchErase(size_t size, Timer& timer) {
+    const size_t num_ops = std::min(size, NumPointOps(size));
+    auto c = MakeFilled<Traits, T>(size);
+    timer.Start();
+    for (size_t i = 0; i < num_ops; ++i) {
+        const size_t current_size = Traits::Size(c);
+        const size_t pos = Where == 0 ? 0 : Where == 1 ? current_size / 2 : current_size - 1;
+        Traits::Erase(c, pos);
+    }
+    DoNotOptimize(c);
+    timer.Stop();
+    return num_ops;
+}
+
+template <typename Traits, typename T>
+size_t BenchCopyAssign(size_t size, Timer& timer) {
+    const auto source = MakeFilled<Traits, T>(size);
+    typename Traits::Container c;
+    timer.Start();
+    c = source;
+    DoNotOptimize(c);
+    timer.Stop();
+    return size;
+}
+
+template <typename Traits, typename T>
+size_t BenchMoveAssign(size_t size, Timer& timer) {
+    auto source = MakeFilled<Traits, T>(size);
+    auto c = MakeFilled<Traits, T>(1);
+    timer.Start();
+    c = std::move(source);
+    DoNotOptimize(c);
+    timer.Stop();
+    return 1;
+}
+
+template <typename Traits, typename T>
+size_t BenchIterate(size_t size, Timer& timer) {
+    const auto c = MakeFilled<Traits, T>(size);
+    timer.Start();
+    uint64_t sum = 0;
+    for (const T& value : c) {
+        sum += Touch(value);
+    }
+    DoNotOptimize(sum);
+    timer.Stop();
+    return size;
+}
+
+// Пиковый RSS процесса в килобайтах с последнего вызова ResetPeakRss
+size_t ReadPeakRssKb() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return 0;
+#endif
+}
+
+void ResetPeakRss() {
+#if defined(__linux__)
+    // Запись "5" в clear_refs сбрасывает VmHWM до текущего RSS
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+#endif
+}
+
+struct Options {
+    size_t max_size = 1'000'000;
+    double min_time = 0.02;
+    std::string filter;
+    bool perf = false;
+    std::string json_path;
+};
+
+struct Result {
+    double ns_per_op = 0;
+    double allocations_per_run = 0;
+    size_t peak_rss_kb = 0;
+    // Счётчики perf на операцию; отрицательные, если не собирались
+    CounterValues counters_per_op = {-1, -1, -1, -1, -1, -1};
+};
+
+// Результат одного бенчмарка для JSON
+struct Record {
+    std::string operation;
+    std::string container;
+    std::string type;
+    size_t size = 0;
+    Result result;
+};
+
+// Состояние запуска: параметры, счётчики perf (с --perf) и результаты для JSON (с --json)
+struct Session {
+    Options options;
+    std::unique_ptr<PerfCounters> counters;
+    std::vector<Record> records;
+};
+
+using BenchFunction = size_t (*)(size_t, Timer&);
+
+// Повторяет прогоны, пока суммарное измеренное время не превысит min_time. Подготовка
+// прогонов не измеряется, но может стоить гораздо дороже них, поэтому общее время
+// на один бенчмарк ограничено десятью min_time
+Result Measure(BenchFunction bench, size_t size, Session& session) {
+    Obj::ResetCounters();
+    C::Reset();
+    ResetPeakRss();
+    PerfCounters* counters = session.counters.get();
+    if (counters != nullptr) {
+        counters->Reset();
+    }
+    Timer timer(counters);
+    size_t num_runs = 0;
+    size_t num_ops = 0;
+    const auto min_time = std::chrono::duration<double>(session.options.min_time);
+    const auto deadline = std::chrono::steady_clock::now() + 10 * min_time;
+    do {
+        num_ops += bench(size, timer);
+        ++num_runs;
+    } while (timer.ElapsedNs() < std::chrono::duration_cast<std::chrono::nanoseconds>(min_time).count()
+             && std::chrono::steady_clock::now() < deadline);
+    Result result;
+    result.ns_per_op = static_cast<double>(timer.ElapsedNs()) / static_cast<double>(num_ops);
+    result.allocations_per_run = static_cast<double>(timer.Allocations()) / static_cast<double>(num_runs);
+    result.peak_rss_kb = ReadPeakRssKb();
+    if (counters != nullptr) {
+        result.counters_per_op = counters->Read();
+        for (double& value : result.counters_per_op) {
+            if (value >= 0) {
+                value /= static_cast<double>(num_ops);
+            }
+        }
+    }
+    return result;
+}
+
+void PrintHeader(const Options& options) {
+    std::printf("%-44s %14s %12s %14s", "benchmark", "ns/op", "allocs/run", "peak RSS, KB");
+    if (options.perf) {
+        std::printf(" %12s %12s %12s %12s %12s %12s", "cycles/op", "instr/op", "L1D miss/op", "LLC miss/op",
+                    "dTLB miss/op", "faults/op");
+    }
+    std::printf("\n");
+}
+
+void PrintResult(const std::string& name, const Result& result, const Options& options) {
+    std::printf("%-44s %14.2f %12.1f %14zu", name.c_str(), result.ns_per_op, result.allocations_per_run,
+                result.peak_rss_kb);
+    if (options.perf) {
+        for (double value : result.counters_per_op) {
+            if (value >= 0) {
+                std::printf(" %12.4g", value);
+            } else {
+                std::printf(" %12s", "-");
+            }
+        }
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+// Строка JSON; имена бенчмарков не содержат управляющих символов
+std::string JsonString(const std::string& value) {
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+// Записывает результаты в JSON: по объекту на бенчмарк, недоступные счётчики — null
+void WriteJson(const Session& session) {
+    std::ofstream out(session.options.json_path);
+    if (!out) {
+        std::cerr << "Cannot open " << session.options.json_path << std::endl;
+        std::exit(1);
+    }
+    out.precision(6);
+    out << "{\n  \"max_size\": " << session.options.max_size << ",\n  \"min_time\": " << session.options.min_time
+        << ",\n  \"perf\": " << (session.counters != nullptr ? "true" : "false");
+    if (session.counters != nullptr && !session.counters->Error().empty()) {
+        out << ",\n  \"perf_error\": " << JsonString(session.counters->Error());
+    }
+    out << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < session.records.size(); ++i) {
+        const Record& record = session.records[i];
+        const Result& result = record.result;
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": "
+            << JsonString(record.operation + "/" + record.container + "/" + record.type + "/" + std::to_string(record.size))
+            << ", \"operation\": " << JsonString(record.operation) << ", \"container\": " << JsonString(record.container)
+            << ", \"type\": " << JsonString(record.type) << ", \"size\": " << record.size
+            << ", \"ns_per_op\": " << result.ns_per_op << ", \"allocations_per_run\": " << result.allocations_per_run
+            << ", \"peak_rss_kb\": " << result.peak_rss_kb;
+        if (session.counters != nullptr) {
+            for (size_t c = 0; c < NUM_COUNTERS; ++c) {
+                out << ", \"" << COUNTER_NAMES[c] << "_per_op\": ";
+                if (result.counters_per_op[c] >= 0) {
+                    out << result.counters_per_op[c];
+                } else {
+                    out << "null";
+                }
+            }
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+template <typename Traits, typename T>
+void RunContainer(const char* type_name, size_t size, Session& session) {
+    const std::array<std::pair<const char*, BenchFunction>, 16> benchmarks{{
+        {"PushBack", &BenchPushBack<Traits, T>},
+        {"EmplaceBack", &BenchEmplaceBack<Traits, T>},
+        {"Reserve", &BenchReserve<Traits, T>},
+        {"InsertFront", &BenchInsert<Traits, T, 0>},
+        {"InsertMiddle", &BenchInsert<Traits, T, 1>},
+        {"InsertBack", &BenchInsert<Traits, T, 2>},
+        {"EmplaceAtFront", &BenchEmplace<Traits, T, 0>},
+        {"EmplaceAtMiddle", &BenchEmplace<Traits, T, 1>},
+        {"EmplaceAtEnd", &BenchEmplace<Traits, T, 2>},
+        {"InsertCopyMiddle", &BenchInsertCopy<Traits, T>},
+        {"EraseFront", &BenchErase<Traits, T, 0>},
+        {"EraseMiddle", &BenchErase<Traits, T, 1>},
+        {"EraseBack", &BenchErase<Traits, T, 2>},
+        {"CopyAssign", &BenchCopyAssign<Traits, T>},
+        {"MoveAssign", &BenchMoveAssign<Traits, T>},
+        {"Iterate", &BenchIterate<Traits, T>},
+    }};
+    for (const auto& [bench_name, bench] : benchmarks) {
+        const std::string name = std::string(bench_name) + "/" + Traits::NAME + "/" + type_name + "/"
+                               + std::to_string(size);
+        if (name.find(session.options.filter) == std::string::npos) {
+            continue;
+        }
+        const Result result = Measure(bench, size, session);
+        PrintResult(name, result, session.options);
+        if (!session.options.json_path.empty()) {
+            session.records.push_back({bench_name, Traits::NAME, type_name, size, result});
+        }
+    }
+}
+
+template <typename T>
+void RunType(const char* type_name, Session& session) {
+    for (size_t size = 1; size <= session.options.max_size; size *= 10) {
+        RunContainer<StdVectorTraits<T>, T>(type_name, size, session);
+        RunContainer<VectorTraits<T>, T>(type_name, size, session);
+        if (size > session.options.max_size / 10) {
+            break;  // Следующая степень 10 превысила бы max_size или переполнилась
+        }
+    }
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&arg](const char* prefix) -> const char* {
+            const size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* max_size = value("--max-size=")) {
+            options.max_size = std::strtoull(max_size, nullptr, 10);
+        } else if (const char* min_time = value("--min-time=")) {
+            options.min_time = std::strtod(min_time, nullptr);
+        } else if (const char* filter = value("--filter=")) {
+            options.filter = filter;
+        } else if (arg == "--perf") {
+            options.perf = true;
+        } else if (const char* json_path = value("--json=")) {
+            options.json_path = json_path;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Session session;
+    session.options = ParseOptions(argc, argv);
+    if (session.options.perf) {
+        session.counters = std::make_unique<PerfCounters>();
+        if (!session.counters->Error().empty()) {
+            std::cerr << "Some perf counters are unavailable (" << session.counters->Error() << ")" << std::endl;
+        }
+    }
+    PrintHeader(session.options);
+    RunType<int>("int", session);
+    RunType<Pod64>("Pod64", session);
+    RunType<std::string>("string", session);
+    RunType<Obj>("Obj", session);
+    RunType<C>("C", session);
+    if (!session.options.json_path.empty()) {
+        WriteJson(session);
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <exception>
+
+// Вектор, в который несколько потоков одновременно добавляют элементы без блокировок.
+// Позиция элемента резервируется одним атомарным инкрементом, а память состоит из сегментов
+// RawMemory растущего размера: сегмент k вмещает FIRST_SEGMENT_SIZE << k элементов.
+// Сегменты не перевыделяются, поэтому адреса элементов не меняются. Отсутствующий сегмент
+// создаёт первый обратившийся к нему поток; при гонке лишний блок освобождается.
+//
+// Одновременно с EmplaceBack безопасно читать только те элементы, добавление которых
+// уже завершилось (и стало видимо читающему потоку). Clear, Freeze и деструктор
+// вызываются, когда все производители закончили работу
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    using Segment = RawMemory<T, Allocator>;
+
+public:
+    static constexpr size_t FIRST_SEGMENT_SIZE = 32;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : alloc_(alloc)
+    {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Добавляет элемент и возвращает ссылку на него. Если конструктор или выделение сегмента
+    // выбросили исключение, зарезервированная позиция остаётся пустой и пропускается
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            T* slot = GetSlot(index);
+            return *new (slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            RecordFailure(index);
+            throw;
+        }
+    }
+
+    template <typename F>
+    T& PushBack(F&& value) {
+        return EmplaceBack(std::forward<F>(value));
+    }
+
+    // Число зарезервированных позиций, включая ещё заполняемые и пустые
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        size_t offset = 0;
+        const size_t k = SegmentIndex(index, offset);
+        return segments_[k].load(std::memory_order_acquire)->GetAddress()[offset];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    // Уничтожает элементы и освобождает сегменты
+    void Clear() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            ForEachRange([](T* first, size_t count) {
+                std::destroy_n(first, count);
+            });
+        }
+        for (std::atomic<Segment*>& segment : segments_) {
+            delete segment.exchange(nullptr, std::memory_order_relaxed);
+        }
+        for (FailedSlot* slot = failed_.exchange(nullptr, std::memory_order_relaxed); slot != nullptr;) {
+            delete std::exchange(slot, slot->next);
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    // Переносит элементы по порядку в один непрерывный Vector, пропуская пустые позиции,
+    // и очищает ConcurrentVector. Тривиально копируемые элементы копируются побайтово
+    // целыми участками сегментов
+    Vector<T, Allocator> Freeze() {
+        Vector<T, Allocator> result(alloc_);
+        const size_t count = Size() - NumFailures();
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            result.ResizeAndOverwrite(count, [this](T* data, size_t /*size*/) {
+                size_t pos = 0;
+                ForEachRange([data, &pos](T* first, size_t n) {
+                    std::memcpy(static_cast<void*>(data + pos), static_cast<const void*>(first), n * sizeof(T));
+                    pos += n;
+                });
+                return pos;
+            });
+        } else {
+            result.Reserve(count);
+            ForEachRange([&result](T* first, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    result.EmplaceBack(std::move_if_noexcept(first[i]));
+                }
+            });
+        }
+        Clear();
+        return result;
+    }
+
+private:
+    struct FailedSlot {
+        size_t index;
+        FailedSlot* next;
+    };
+
+    // Сегментов хватает на любой индекс size_t
+    static constexpr size_t MAX_SEGMENTS = 64;
+
+    Allocator alloc_;
+    std::atomic<size_t> size_{0};
+    std::atomic<Segment*> segments_[MAX_SEGMENTS] = {};
+    std::atomic<FailedSlot*> failed_{nullptr};
+
+    static size_t SegmentSize(size_t k) noexcept {
+        return FIRST_SEGMENT_SIZE << k;
+    }
+
+    // Номер сегмента с позицией index и смещение позиции в нём
+    static size_t SegmentIndex(size_t index, size_t& offset) noexcept {
+        // Сегмент k начинается с позиции FIRST_SEGMENT_SIZE * (2^k - 1)
+        const size_t block = index / FIRST_SEGMENT_SIZE + 1;
+        size_t k = 0;
+#if defined(__GNUC__) || defined(__clang__)
+        k = sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(block);
+#else
+        while ((block >> (k + 1)) != 0) {
+            ++k;
+        }
+#endif
+        offset = index - FIRST_SEGMENT_SIZE * ((size_t(1) << k) - 1);
+        return k;
+    }
+
+    T* GetSlot(size_t index) {
+        size_t offset = 0;
+        const size_t k = SegmentIndex(index, offset);
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        if (segment == nullptr) {
+            auto candidate = std::make_unique<Segment>(SegmentSize(k), alloc_);
+            // Одна попытка: либо публикуем свой сегмент, либо получаем опубликованный другим потоком
+            if (segments_[k].compare_exchange_strong(segment, candidate.get(), std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+                segment = candidate.release();
+            }
+        }
+        return segment->GetAddress() + offset;
+    }
+
+    void RecordFailure(size_t index) noexcept {
+        // Без записи о пустой позиции нельзя корректно уничтожить элементы
+        FailedSlot* slot = new (std::nothrow) FailedSlot{index, failed_.load(std::memory_order_relaxed)};
+        if (slot == nullptr) {
+            std::terminate();
+        }
+        while (!failed_.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Упорядочивает список пустых позиций по индексу на месте слиянием, не выделяя памяти
+    static FailedSlot* SortSlots(FailedSlot* head) noexcept {
+        if (head == nullptr || head->next == nullptr) {
+            return head;
+        }
+        FailedSlot* slow = head;
+        for (FailedSlot* fast = head->next; fast != nullptr && fast->next != nullptr; fast = fast->next->next) {
+            slow = slow->next;
+        }
+        FailedSlot* lhs = SortSlots(std::exchange(slow->next, nullptr));
+        FailedSlot* rhs = SortSlots(head);
+        FailedSlot merged{0, nullptr};
+        FailedSlot* tail = &merged;
+        while (lhs != nullptr && rhs != nullptr) {
+            FailedSlot*& smaller = lhs->index < rhs->index ? lhs : rhs;
+            tail = tail->next = smaller;
+            smaller = smaller->next;
+        }
+        tail->next = lhs != nullptr ? lhs : rhs;
+        return merged.next;
+    }
+
+    // Упорядочивает пустые позиции и возвращает первую из них
+    const FailedSlot* SortFailures() noexcept {
+        FailedSlot* head = SortSlots(failed_.load(std::memory_order_acquire));
+        failed_.store(head, std::memory_order_relaxed);
+        return head;
+    }
+
+    size_t NumFailures() const noexcept {
+        size_t count = 0;
+        for (const FailedSlot* slot = failed_.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Вызывает op(first, count) для каждого непрерывного участка созданных элементов по порядку
+    template <typename Op>
+    void ForEachRange(Op op) {
+        const FailedSlot* next_failure = SortFailures();
+        const size_t size = Size();
+        for (size_t k = 0, start = 0; start < size; start += SegmentSize(k), ++k) {
+            const size_t end = std::min(size, start + SegmentSize(k));
+            Segment* segment = segments_[k].load(std::memory_order_acquire);
+            size_t first = start;
+            while (first < end) {
+                // Пустая позиция учитывается, только если лежит в текущем сегменте
+                const bool has_failure = next_failure != nullptr && next_failure->index < end;
+                const size_t last = has_failure ? next_failure->index : end;
+                if (last > first) {
+                    op(segment->GetAddress() + (first - start), last - first);
+                }
+                first = last;
+                if (has_failure) {
+                    next_failure = next_failure->next;
+                    ++first;
+                }
+            }
+        }
+    }
+};
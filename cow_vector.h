@@ -0,0 +1,179 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <initializer_list>
+#include <utility>
+
+// Вектор с копированием при записи. Копия CowVector не копирует элементы, а разделяет с
+// оригиналом блок с атомарным счётчиком ссылок: копирование стоит одного атомарного
+// инкремента. Первое изменение через вектор, разделяющий блок, отсоединяет его: элементы
+// копируются в собственный блок, остальные владельцы продолжают видеть прежние значения.
+//
+// Как и std::shared_ptr, один объект CowVector нельзя менять из нескольких потоков, но
+// разные копии, разделяющие блок, можно читать, копировать, менять и уничтожать одновременно.
+// Поэтому снимок можно опубликовать, а читатели копируют его к себе. Неконстантного
+// operator[] нет, чтобы чтение не отсоединяло блок; изменения идут через Mutable()
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DoublingGrowth>
+class CowVector {
+public:
+    using vector_type = Vector<T, Allocator, Growth>;
+    using value_type = T;
+    using const_iterator = const T*;
+
+    CowVector() = default;
+
+    CowVector(std::initializer_list<T> values)
+        : CowVector(vector_type(values))
+    {
+    }
+
+    // Забирает элементы вектора без копирования
+    explicit CowVector(vector_type&& values)
+        : shared_(new Shared{std::move(values)})
+    {
+    }
+
+    CowVector(const CowVector& other) noexcept
+        : shared_(other.shared_)
+    {
+        if (shared_ != nullptr) {
+            shared_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowVector(CowVector&& other) noexcept
+        : shared_(std::exchange(other.shared_, nullptr))
+    {
+    }
+
+    CowVector& operator=(const CowVector& rhs) noexcept {
+        if (this != &rhs) {
+            CowVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        if (this != &rhs) {
+            CowVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~CowVector() {
+        Unref();
+    }
+
+    void Swap(CowVector& other) noexcept {
+        std::swap(shared_, other.shared_);
+    }
+
+    // Элементы только для чтения; ссылка действительна до изменения или уничтожения этого объекта
+    const vector_type& Get() const noexcept {
+        static const vector_type EMPTY;
+        return shared_ != nullptr ? shared_->values : EMPTY;
+    }
+
+    // Отсоединяет блок, если он разделён, и возвращает вектор для изменения. Ссылка
+    // действительна до следующего копирования этого объекта: копия снова разделит блок
+    vector_type& Mutable() {
+        if (shared_ == nullptr) {
+            shared_ = new Shared{vector_type()};
+        } else if (shared_->refs.load(std::memory_order_acquire) != 1) {
+            // Значение 1 не может измениться: другие владельцы не могут скопировать наш блок
+            Shared* own = new Shared{shared_->values};
+            Unref();
+            shared_ = own;
+        }
+        return shared_->values;
+    }
+
+    // Число объектов CowVector, разделяющих блок; 0 у пустого вектора без блока
+    size_t UseCount() const noexcept {
+        return shared_ != nullptr ? shared_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    // Разделяют ли два вектора один блок
+    bool SharesWith(const CowVector& other) const noexcept {
+        return shared_ != nullptr && shared_ == other.shared_;
+    }
+
+    size_t Size() const noexcept {
+        return Get().Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return Get().Capacity();
+    }
+
+    const T* Data() const noexcept {
+        return Get().Data();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return Get()[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return Get().begin();
+    }
+
+    const_iterator end() const noexcept {
+        return Get().end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    void PushBack(F&& value) {
+        Mutable().PushBack(std::forward<F>(value));
+    }
+
+    void PopBack() {
+        Mutable().PopBack();
+    }
+
+    void Resize(size_t new_size) {
+        Mutable().Resize(new_size);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutable().Reserve(new_capacity);
+    }
+
+    // Отпускает блок, не копируя элементы; вместимость не сохраняется
+    void Clear() noexcept {
+        Unref();
+        shared_ = nullptr;
+    }
+
+private:
+    struct Shared {
+        vector_type values;
+        std::atomic<size_t> refs{1};
+    };
+
+    Shared* shared_ = nullptr;
+
+    void Unref() noexcept {
+        // acq_rel: уничтожение блока видит все изменения, сделанные последним владельцем
+        if (shared_ != nullptr && shared_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete shared_;
+        }
+    }
+};
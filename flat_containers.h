@@ -0,0 +1,494 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+// Первый элемент [first, first + count), ключ которого не меньше key. Вместо ветвления на
+// каждом шаге выбирается половина диапазона, что компилятор превращает в условное присваивание:
+// поиск не страдает от ошибок предсказания переходов и проходит за ровно log2(count) шагов
+template <typename It, typename Key, typename KeyOf, typename Compare>
+It BranchlessLowerBound(It first, size_t count, const Key& key, const KeyOf& key_of, const Compare& comp) {
+    if (count == 0) {
+        return first;
+    }
+    while (count > 1) {
+        const size_t half = count / 2;
+        first = comp(key_of(first[half]), key) ? first + half : first;
+        count -= half;
+    }
+    return first + comp(key_of(*first), key);
+}
+
+// Общая часть FlatSet и FlatMap: элементы хранятся в Vector упорядоченными по ключу
+// KeyOf()(element) без повторов. Поиск — двоичный по непрерывной памяти, без переходов
+// по указателям. Одиночная вставка и удаление сдвигают хвост; пакетная вставка добавляет
+// элементы в конец одним Append, сортирует их и сливает с прежними за один проход, а
+// пакетное удаление сдвигает оставшиеся элементы один раз. При равных ключах остаётся
+// элемент, добавленный раньше, как у std::map::insert
+template <typename Element, typename Key, typename KeyOf, typename Compare, typename Allocator>
+class FlatTable {
+public:
+    using key_type = Key;
+    using value_type = Element;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using container_type = Vector<Element, Allocator>;
+    using const_iterator = const Element*;
+
+    FlatTable() = default;
+
+    explicit FlatTable(const Compare& comp, const Allocator& alloc = Allocator())
+        : values_(alloc)
+        , comp_(comp)
+    {
+    }
+
+    // Сортирует элементы вектора и удаляет повторы, не копируя их
+    explicit FlatTable(container_type values, const Compare& comp = Compare())
+        : values_(std::move(values))
+        , comp_(comp)
+    {
+        SortAndMerge(0);
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    FlatTable(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : FlatTable(comp, alloc)
+    {
+        Insert(first, last);
+    }
+
+    FlatTable(std::initializer_list<Element> values, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : FlatTable(values.begin(), values.end(), comp, alloc)
+    {
+    }
+
+    size_t Size() const noexcept {
+        return values_.Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return values_.Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        values_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        values_.Clear();
+    }
+
+    // Упорядоченные элементы
+    const container_type& Values() const noexcept {
+        return values_;
+    }
+
+    // Забирает упорядоченные элементы, оставляя таблицу пустой
+    container_type Extract() {
+        return std::exchange(values_, container_type(values_.GetAllocator()));
+    }
+
+    const key_compare& KeyComp() const noexcept {
+        return comp_;
+    }
+
+    const_iterator begin() const noexcept {
+        return values_.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return values_.end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_iterator LowerBound(const Key& key) const {
+        return BranchlessLowerBound(values_.begin(), values_.Size(), key, KeyOf(), comp_);
+    }
+
+    const_iterator UpperBound(const Key& key) const {
+        const_iterator it = LowerBound(key);
+        return it != end() && !comp_(key, KeyOf()(*it)) ? it + 1 : it;
+    }
+
+    const_iterator Find(const Key& key) const {
+        const_iterator it = LowerBound(key);
+        return it != end() && !comp_(key, KeyOf()(*it)) ? it : end();
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Пакетная вставка за O(n + k log k) вместо k сдвигов хвоста
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void Insert(InputIt first, InputIt last) {
+        const size_t old_size = values_.Size();
+        values_.Append(first, last);
+        SortAndMerge(old_size);
+    }
+
+    void Insert(std::initializer_list<Element> values) {
+        Insert(values.begin(), values.end());
+    }
+
+    size_t Erase(const Key& key) {
+        const const_iterator it = Find(key);
+        if (it == end()) {
+            return 0;
+        }
+        values_.Erase(it);
+        return 1;
+    }
+
+    // Удаляет элементы с ключами из [first, last) за один проход по таблице
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t EraseKeys(InputIt first, InputIt last) {
+        Vector<Key> keys;
+        keys.Append(first, last);
+        std::sort(keys.begin(), keys.end(), comp_);
+        const Key* key = keys.begin();
+        return EraseIf([this, &key, &keys](const Element& element) {
+            const Key& element_key = KeyOf()(element);
+            while (key != keys.end() && comp_(*key, element_key)) {
+                ++key;
+            }
+            return key != keys.end() && !comp_(element_key, *key);
+        });
+    }
+
+    // Удаляет элементы, для которых pred возвращает true; порядок оставшихся сохраняется
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        return ::EraseIf(values_, pred);
+    }
+
+protected:
+    container_type values_;
+    Compare comp_;
+
+    Element* ToMutable(const_iterator it) noexcept {
+        return values_.begin() + (it - values_.cbegin());
+    }
+
+    bool Equivalent(const Element& lhs, const Element& rhs) const {
+        return !comp_(KeyOf()(lhs), KeyOf()(rhs)) && !comp_(KeyOf()(rhs), KeyOf()(lhs));
+    }
+
+    // Создаёт элемент из args перед первым элементом с ключом не меньше key, если такого ключа
+    // ещё нет. Аргументы могут ссылаться на элементы таблицы
+    template <typename... Args>
+    std::pair<Element*, bool> EmplaceUnique(const Key& key, Args&&... args) {
+        const const_iterator it = LowerBound(key);
+        if (it != end() && !comp_(key, KeyOf()(*it))) {
+            return {ToMutable(it), false};
+        }
+        return {values_.Emplace(it, std::forward<Args>(args)...), true};
+    }
+
+    // Упорядочивает элементы [sorted_size, Size()) и сливает их с упорядоченными [0, sorted_size).
+    // Если сравнение или перемещение выбросит исключение во время слияния, таблица очищается
+    void SortAndMerge(size_t sorted_size) {
+        const auto less = [this](const Element& lhs, const Element& rhs) {
+            return comp_(KeyOf()(lhs), KeyOf()(rhs));
+        };
+        Element* middle = values_.begin() + sorted_size;
+        try {
+            std::stable_sort(middle, values_.end(), less);
+        } catch (...) {
+            values_.Erase(middle, values_.end());
+            throw;
+        }
+        try {
+            // Новые ключи часто идут после всех прежних, и тогда сливать нечего
+            if (sorted_size != 0 && middle != values_.end() && less(*middle, *(middle - 1))) {
+                std::inplace_merge(values_.begin(), middle, values_.end(), less);
+            }
+            // Слияние устойчиво, поэтому из равных остаётся прежний элемент
+            Element* new_end = std::unique(values_.begin(), values_.end(), [this](const Element& lhs, const Element& rhs) {
+                return Equivalent(lhs, rhs);
+            });
+            values_.Erase(new_end, values_.end());
+        } catch (...) {
+            values_.Clear();
+            throw;
+        }
+    }
+};
+
+// Ключом элемента FlatSet служит сам элемент
+struct FlatSetKeyOf {
+    template <typename T>
+    const T& operator()(const T& value) const noexcept {
+        return value;
+    }
+};
+
+// Упорядоченное множество на Vector. Итераторы константные: изменение элемента нарушило бы порядок.
+// Итераторы и ссылки становятся недействительными при любой вставке и удалении
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class FlatSet : public FlatTable<Key, Key, FlatSetKeyOf, Compare, Allocator> {
+    using Base = FlatTable<Key, Key, FlatSetKeyOf, Compare, Allocator>;
+
+public:
+    using typename Base::const_iterator;
+    using iterator = const_iterator;
+
+    using Base::Base;
+    using Base::Erase;
+    using Base::Insert;
+
+    std::pair<iterator, bool> Insert(const Key& key) {
+        return Base::EmplaceUnique(key, key);
+    }
+
+    std::pair<iterator, bool> Insert(Key&& key) {
+        return Base::EmplaceUnique(key, std::move(key));
+    }
+
+    iterator Erase(const_iterator pos) {
+        return Base::values_.Erase(pos);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        return Base::values_.Erase(first, last);
+    }
+};
+
+// Ключом элемента FlatMap служит first
+struct FlatMapKeyOf {
+    template <typename K, typename V>
+    const K& operator()(const std::pair<K, V>& value) const noexcept {
+        return value.first;
+    }
+};
+
+// Неконстантный итератор FlatMap. Разыменование даёт пару ссылок на константный ключ и
+// изменяемое значение, поэтому через итератор нельзя нарушить порядок; operator-> возвращает
+// прокси-объект с этой парой. Преобразуется в константный итератор const std::pair<Key, Value>*
+template <typename Key, typename Value>
+class FlatMapIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<Key, Value>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key&, Value&>;
+
+    class pointer {
+    public:
+        const reference* operator->() const noexcept {
+            return &ref_;
+        }
+
+    private:
+        friend class FlatMapIterator;
+
+        explicit pointer(const reference& ref) noexcept
+            : ref_(ref)
+        {
+        }
+
+        reference ref_;
+    };
+
+    FlatMapIterator() = default;
+
+    explicit FlatMapIterator(value_type* ptr) noexcept
+        : ptr_(ptr)
+    {
+    }
+
+    operator const value_type*() const noexcept {
+        return ptr_;
+    }
+
+    reference operator*() const noexcept {
+        return {ptr_->first, ptr_->second};
+    }
+
+    pointer operator->() const noexcept {
+        return pointer(**this);
+    }
+
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    FlatMapIterator& operator++() noexcept {
+        ++ptr_;
+        return *this;
+    }
+
+    FlatMapIterator operator++(int) noexcept {
+        return FlatMapIterator(ptr_++);
+    }
+
+    FlatMapIterator& operator--() noexcept {
+        --ptr_;
+        return *this;
+    }
+
+    FlatMapIterator operator--(int) noexcept {
+        return FlatMapIterator(ptr_--);
+    }
+
+    FlatMapIterator& operator+=(difference_type offset) noexcept {
+        ptr_ += offset;
+        return *this;
+    }
+
+    FlatMapIterator& operator-=(difference_type offset) noexcept {
+        ptr_ -= offset;
+        return *this;
+    }
+
+    FlatMapIterator operator+(difference_type offset) const noexcept {
+        return FlatMapIterator(ptr_ + offset);
+    }
+
+    friend FlatMapIterator operator+(difference_type offset, const FlatMapIterator& it) noexcept {
+        return it + offset;
+    }
+
+    FlatMapIterator operator-(difference_type offset) const noexcept {
+        return FlatMapIterator(ptr_ - offset);
+    }
+
+    difference_type operator-(const FlatMapIterator& other) const noexcept {
+        return ptr_ - other.ptr_;
+    }
+
+    bool operator==(const FlatMapIterator& other) const noexcept {
+        return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(const FlatMapIterator& other) const noexcept {
+        return ptr_ != other.ptr_;
+    }
+
+    bool operator<(const FlatMapIterator& other) const noexcept {
+        return ptr_ < other.ptr_;
+    }
+
+    bool operator<=(const FlatMapIterator& other) const noexcept {
+        return ptr_ <= other.ptr_;
+    }
+
+    bool operator>(const FlatMapIterator& other) const noexcept {
+        return ptr_ > other.ptr_;
+    }
+
+    bool operator>=(const FlatMapIterator& other) const noexcept {
+        return ptr_ >= other.ptr_;
+    }
+
+private:
+    value_type* ptr_ = nullptr;
+};
+
+// Упорядоченный словарь на Vector. Пары хранятся подряд; ключ пары не константный, чтобы
+// элементы можно было сдвигать присваиванием, но FlatMapIterator даёт к нему доступ только
+// для чтения. Итераторы и ссылки становятся недействительными при любой вставке и удалении
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<std::pair<Key, Value>>>
+class FlatMap : public FlatTable<std::pair<Key, Value>, Key, FlatMapKeyOf, Compare, Allocator> {
+    using Base = FlatTable<std::pair<Key, Value>, Key, FlatMapKeyOf, Compare, Allocator>;
+
+public:
+    using mapped_type = Value;
+    using typename Base::value_type;
+    using typename Base::const_iterator;
+    using iterator = FlatMapIterator<Key, Value>;
+
+    using Base::Base;
+    using Base::begin;
+    using Base::end;
+    using Base::Erase;
+    using Base::Find;
+    using Base::Insert;
+
+    iterator begin() noexcept {
+        return iterator(Base::values_.begin());
+    }
+
+    iterator end() noexcept {
+        return iterator(Base::values_.end());
+    }
+
+    iterator Find(const Key& key) {
+        return iterator(Base::ToMutable(Base::Find(key)));
+    }
+
+    // Значение по ключу; отсутствующий ключ добавляется со значением по умолчанию
+    Value& operator[](const Key& key) {
+        return TryEmplace(key).first->second;
+    }
+
+    Value& At(const Key& key) {
+        const iterator it = Find(key);
+        if (it == end()) {
+            throw std::out_of_range("FlatMap key not found");
+        }
+        return it->second;
+    }
+
+    const Value& At(const Key& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    std::pair<iterator, bool> Insert(const value_type& value) {
+        return Wrap(Base::EmplaceUnique(value.first, value));
+    }
+
+    std::pair<iterator, bool> Insert(value_type&& value) {
+        return Wrap(Base::EmplaceUnique(value.first, std::move(value)));
+    }
+
+    // Создаёт значение из args, только если ключа ещё нет
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+        return Wrap(Base::EmplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                        std::forward_as_tuple(std::forward<Args>(args)...)));
+    }
+
+    // Добавляет пару или заменяет значение существующего ключа
+    template <typename V>
+    std::pair<iterator, bool> InsertOrAssign(const Key& key, V&& value) {
+        const auto result = TryEmplace(key, std::forward<V>(value));
+        if (!result.second) {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    iterator Erase(const_iterator pos) {
+        return iterator(Base::values_.Erase(pos));
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        return iterator(Base::values_.Erase(first, last));
+    }
+
+private:
+    static std::pair<iterator, bool> Wrap(std::pair<value_type*, bool> result) noexcept {
+        return {iterator(result.first), result.second};
+    }
+};
@@ -0,0 +1,277 @@
+#pragma once
+
+#include "vector.h"
+#include "index_iterator.h"
+
+#include <type_traits>
+#include <utility>
+
+// Вектор с ограниченным временем EmplaceBack. Когда вместимость исчерпана, выделяется новый
+// блок, но старые элементы переносятся не сразу, а понемногу при следующих EmplaceBack:
+// каждый вызов переносит не больше MigrationStep() элементов. Шаг рассчитан так, что перенос
+// заканчивается раньше, чем заполнится новый блок, поэтому в худшем случае EmplaceBack
+// стоит O(1) переносов вместо O(N). Migrate позволяет продвинуть перенос в свободное время.
+//
+// Пока идёт перенос, элементы [MigratedCount(), размер блока до роста) лежат в старом блоке,
+// остальные — в новом; operator[] выбирает блок одним сравнением и ничего не переносит.
+// Ссылки на элементы становятся недействительными при любом добавлении, итераторы хранят индекс
+// и остаются действительными. Перенос не может выбросить исключение, поэтому перемещающий
+// конструктор T должен быть noexcept, если тип не тривиально перемещаемый
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DoublingGrowth>
+class IncrementalVector {
+    static_assert(IsTriviallyRelocatable<T>::value || std::is_nothrow_move_constructible_v<T>,
+                  "IncrementalVector requires a trivially relocatable or nothrow move constructible type");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using allocator_type = Allocator;
+    using value_type = T;
+    using iterator = IndexIterator<IncrementalVector, T&>;
+    using const_iterator = IndexIterator<const IncrementalVector, const T&>;
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Allocator& alloc) noexcept
+        : data_(alloc)
+        , old_data_(alloc)
+    {
+    }
+
+    // Делегирующий конструктор: если копирование элемента выбросит исключение,
+    // деструктор уничтожит уже скопированные
+    IncrementalVector(const IncrementalVector& other)
+        : IncrementalVector(AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        Reserve(other.size_);
+        for (size_t i = 0; i < other.size_; ++i) {
+            EmplaceBack(other[i]);
+        }
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_data_(std::move(other.old_data_))
+        , size_(std::exchange(other.size_, 0))
+        , old_size_(std::exchange(other.old_size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0))
+        , step_(std::exchange(other.step_, 0))
+    {
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            IncrementalVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+        if (this != &rhs) {
+            IncrementalVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        DestroyElements();
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_data_.Swap(other.old_data_);
+        std::swap(size_, other.size_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(step_, other.step_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // Объём памяти в байтах, включая ещё не освобождённый старый блок
+    size_t BytesAllocated() const noexcept {
+        return (data_.Capacity() + old_data_.Capacity()) * sizeof(T);
+    }
+
+    // Идёт ли перенос элементов из старого блока
+    bool IsMigrating() const noexcept {
+        return migrated_ < old_size_;
+    }
+
+    // Сколько элементов старого блока уже перенесено
+    size_t MigratedCount() const noexcept {
+        return migrated_;
+    }
+
+    // Сколько элементов переносит один EmplaceBack во время переноса
+    size_t MigrationStep() const noexcept {
+        return step_;
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index >= migrated_ && index < old_size_ ? old_data_[index] : data_[index];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Переносит не больше max_elements элементов старого блока и освобождает его,
+    // когда перенос закончен. Возвращает, сколько элементов осталось перенести
+    size_t Migrate(size_t max_elements = size_t(-1)) noexcept {
+        const size_t count = std::min(max_elements, old_size_ - migrated_);
+        T* from = old_data_.GetAddress() + migrated_;
+        T* to = data_.GetAddress() + migrated_;
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            RelocateTrivially(from, count, to);
+        } else {
+            std::uninitialized_move_n(from, count, to);
+            std::destroy_n(from, count);
+        }
+        migrated_ += count;
+        if (migrated_ == old_size_ && old_data_.Capacity() != 0) {
+            old_data_ = RawMemory<T, Allocator>(GetAllocator());
+            old_size_ = migrated_ = 0;
+        }
+        return old_size_ - migrated_;
+    }
+
+    // Явное резервирование переносит все элементы сразу, как Vector::Reserve
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+        Migrate();
+        T* from = data_.GetAddress();
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            RelocateTrivially(from, size_, new_data.GetAddress());
+        } else {
+            std::uninitialized_move_n(from, size_, new_data.GetAddress());
+            std::destroy_n(from, size_);
+        }
+        RecordReallocation(Capacity(), new_capacity);
+        data_.Swap(new_data);
+    }
+
+    // Удаляет все элементы. Вместимость сохраняется, если не запрошено освобождение памяти
+    void Clear(bool release_capacity = false) noexcept {
+        DestroyElements();
+        size_ = old_size_ = migrated_ = 0;
+        old_data_ = RawMemory<T, Allocator>(GetAllocator());
+        if (release_capacity) {
+            data_ = RawMemory<T, Allocator>(GetAllocator());
+        }
+    }
+
+    template <typename F>
+    void PushBack(F&& value) {
+        EmplaceBack(std::forward<F>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            StartMigration(Growth::NextCapacity(Capacity(), size_ + 1, sizeof(T)));
+        }
+        // Элемент создаётся до шага переноса: аргументы могут ссылаться на элементы старого блока
+        T* value = new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        if (IsMigrating()) {
+            Migrate(step_);
+        }
+        return *value;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(&(*this)[size_ - 1]);
+        --size_;
+        if (size_ < old_size_) {
+            // Удалён последний элемент старого блока, который ещё не перенесён
+            old_size_ = size_;
+            migrated_ = std::min(migrated_, old_size_);
+            Migrate(0);
+        }
+    }
+
+private:
+    // Новый блок: перенесённые элементы [0, migrated_) и добавленные после роста [old_size_, size_)
+    RawMemory<T, Allocator> data_;
+    // Старый блок с ещё не перенесёнными элементами [migrated_, old_size_)
+    RawMemory<T, Allocator> old_data_;
+    size_t size_ = 0;
+    size_t old_size_ = 0;
+    size_t migrated_ = 0;
+    size_t step_ = 0;
+
+    // Выделяет блок вместимостью new_capacity и начинает перенос в него элементов
+    void StartMigration(size_t new_capacity) {
+        // По построению шага прежний перенос к этому моменту закончен
+        assert(!IsMigrating());
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+        RecordReallocation(Capacity(), new_capacity);
+        data_.Swap(new_data);
+        old_data_.Swap(new_data);
+        old_size_ = size_;
+        migrated_ = 0;
+        // Шаг, при котором перенос заканчивается за new_capacity - size_ добавлений
+        const size_t free_slots = new_capacity - size_;
+        step_ = (old_size_ + free_slots - 1) / free_slots;
+        if (old_size_ == 0) {
+            old_data_ = RawMemory<T, Allocator>(GetAllocator());
+        }
+    }
+
+    void DestroyElements() noexcept {
+        std::destroy_n(data_.GetAddress(), migrated_);
+        std::destroy_n(old_data_.GetAddress() + migrated_, old_size_ - migrated_);
+        std::destroy_n(data_.GetAddress() + old_size_, size_ - old_size_);
+    }
+
+    // Сообщает инструментированию о начале переноса size_ элементов
+    void RecordReallocation([[maybe_unused]] size_t old_capacity, [[maybe_unused]] size_t new_capacity) const noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        VectorInstrumentation::OnReallocation({this, sizeof(T), old_capacity, new_capacity, size_,
+                                               IsTriviallyRelocatable<T>::value ? RelocationKind::BITWISE
+                                                                                : RelocationKind::MOVE});
+#endif
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// Итератор произвольного доступа, хранящий контейнер и индекс элемента. Разыменование
+// вызывает operator[] контейнера, поэтому итератор остаётся действительным, когда элементы
+// переносятся в другую память, и подходит для контейнеров, чей operator[] возвращает
+// прокси-объект (тогда pointer и operator-> недоступны). Owner — тип контейнера,
+// для константного итератора — const Owner
+template <typename Owner, typename Reference>
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::remove_const_t<Owner>::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<std::is_reference_v<Reference>, std::remove_reference_t<Reference>*, void>;
+    using reference = Reference;
+
+    IndexIterator() = default;
+
+    IndexIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index)
+    {
+    }
+
+    // Неконстантный итератор преобразуется в константный
+    template <typename OtherOwner, typename OtherReference,
+              typename = std::enable_if_t<std::is_same_v<const OtherOwner, Owner> && !std::is_same_v<OtherOwner, Owner>>>
+    IndexIterator(const IndexIterator<OtherOwner, OtherReference>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_)
+    {
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    template <typename R = Reference, typename = std::enable_if_t<std::is_reference_v<R>>>
+    pointer operator->() const noexcept {
+        return &(*owner_)[index_];
+    }
+
+    reference operator[](difference_type offset) const noexcept {
+        return (*owner_)[index_ + offset];
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    IndexIterator operator++(int) noexcept {
+        return IndexIterator(owner_, index_++);
+    }
+
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    IndexIterator operator--(int) noexcept {
+        return IndexIterator(owner_, index_--);
+    }
+
+    IndexIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+
+    IndexIterator operator+(difference_type offset) const noexcept {
+        return IndexIterator(owner_, index_ + offset);
+    }
+
+    friend IndexIterator operator+(difference_type offset, const IndexIterator& it) noexcept {
+        return it + offset;
+    }
+
+    IndexIterator operator-(difference_type offset) const noexcept {
+        return IndexIterator(owner_, index_ - offset);
+    }
+
+    difference_type operator-(const IndexIterator& other) const noexcept {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+
+    bool operator==(const IndexIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+
+    bool operator!=(const IndexIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+    bool operator<(const IndexIterator& other) const noexcept {
+        return index_ < other.index_;
+    }
+
+    bool operator<=(const IndexIterator& other) const noexcept {
+        return index_ <= other.index_;
+    }
+
+    bool operator>(const IndexIterator& other) const noexcept {
+        return index_ > other.index_;
+    }
+
+    bool operator>=(const IndexIterator& other) const noexcept {
+        return index_ >= other.index_;
+    }
+
+private:
+    template <typename, typename>
+    friend class IndexIterator;
+
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
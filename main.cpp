@@ -1,123 +1,39 @@
+// Тесты собираются с инструментированием, чтобы проверить и его, и работу векторов под ним
+#define VECTOR_ENABLE_STATS
+
 #include "vector.h"
+#include "aligned_allocator.h"
+#include "arena_allocator.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_containers.h"
+#include "incremental_vector.h"
+#include "malloc_allocator.h"
+#include "mapped_vector.h"
+#include "numa_allocator.h"
+#include "segmented_vector.h"
+#include "serialization.h"
+#include "simd_algorithms.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "static_vector.h"
+#include "test_objects.h"
 
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
-namespace {
-
-// "Магическое" число, используемое для отслеживания живости объекта
-inline const uint32_t DEFAULT_COOKIE = 0xdeadbeef;
-
-struct TestObj {
-    TestObj() = default;
-    TestObj(const TestObj& other) = default;
-    TestObj& operator=(const TestObj& other) = default;
-    TestObj(TestObj&& other) = default;
-    TestObj& operator=(TestObj&& other) = default;
-    ~TestObj() {
-        cookie = 0;
-    }
-    [[nodiscard]] bool IsAlive() const noexcept {
-        return cookie == DEFAULT_COOKIE;
-    }
-    uint32_t cookie = DEFAULT_COOKIE;
-};
-
-struct Obj {
-    Obj() {
-        if (default_construction_throw_countdown > 0) {
-            if (--default_construction_throw_countdown == 0) {
-                throw std::runtime_error("Oops");
-            }
-        }
-        ++num_default_constructed;
-    }
-
-    explicit Obj(int id)
-        : id(id)  //
-    {
-        ++num_constructed_with_id;
-    }
-
-    Obj(int id, std::string name)
-        : id(id)
-        , name(std::move(name))  //
-    {
-        ++num_constructed_with_id_and_name;
-    }
-
-    Obj(const Obj& other)
-        : id(other.id)  //
-    {
-        if (other.throw_on_copy) {
-            throw std::runtime_error("Oops");
-        }
-        ++num_copied;
-    }
-
-    Obj(Obj&& other) noexcept
-        : id(other.id)  //
-    {
-        ++num_moved;
-    }
-
-    Obj& operator=(const Obj& other) {
-        if (this != &other) {
-            id = other.id;
-            name = other.name;
-            ++num_assigned;
-        }
-        return *this;
-    }
-
-    Obj& operator=(Obj&& other) noexcept {
-        id = other.id;
-        name = std::move(other.name);
-        ++num_move_assigned;
-        return *this;
-    }
-
-    ~Obj() {
-        ++num_destroyed;
-        id = 0;
-    }
-
-    static int GetAliveObjectCount() {
-        return num_default_constructed + num_copied + num_moved + num_constructed_with_id
-            + num_constructed_with_id_and_name - num_destroyed;
-    }
-
-    static void ResetCounters() {
-        default_construction_throw_countdown = 0;
-        num_default_constructed = 0;
-        num_copied = 0;
-        num_moved = 0;
-        num_destroyed = 0;
-        num_constructed_with_id = 0;
-        num_constructed_with_id_and_name = 0;
-        num_assigned = 0;
-        num_move_assigned = 0;
-    }
-
-    bool throw_on_copy = false;
-    int id = 0;
-    std::string name;
-
-    static inline int default_construction_throw_countdown = 0;
-    static inline int num_default_constructed = 0;
-    static inline int num_constructed_with_id = 0;
-    static inline int num_constructed_with_id_and_name = 0;
-    static inline int num_copied = 0;
-    static inline int num_moved = 0;
-    static inline int num_destroyed = 0;
-    static inline int num_assigned = 0;
-    static inline int num_move_assigned = 0;
-};
-
-}  // namespace
-
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -558,84 +474,2155 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+// Аллокатор, считающий выделения и освобождения памяти через общий счётчик
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    struct Counters {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t bytes_allocated = 0;
+    };
+
+    explicit CountingAllocator(Counters* counters) noexcept
+        : counters(counters) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : counters(other.counters) {
+    }
+
+    T* allocate(size_t n) {
+        ++counters->allocations;
+        counters->bytes_allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ++counters->deallocations;
+        std::allocator<T>().deallocate(p, n);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return counters == other.counters;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept {
+        return !(*this == other);
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+
+    Counters* counters;
+};
+
+// Аллокатор, который переходит к вектору при копирующем присваивании, но не при обмене
+template <typename T>
+struct CopyPropagatingAllocator : CountingAllocator<T> {
+    using propagate_on_container_copy_assignment = std::true_type;
+    using CountingAllocator<T>::CountingAllocator;
+};
+
+void Test7() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    using Alloc = CountingAllocator<Obj>;
+    {
+        Obj::ResetCounters();
+        Alloc::Counters counters;
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc(&counters));
+            assert(counters.allocations == 1);
+            assert(counters.bytes_allocated == SIZE * sizeof(Obj));
+            v.EmplaceBack(ID);
+            assert(counters.allocations == 2);
+            assert(counters.deallocations == 1);
+            assert(v.GetAllocator() == Alloc(&counters));
+
+            Vector<Obj, Alloc> v_copy(v);
+            assert(v_copy.GetAllocator() == v.GetAllocator());
+            assert(counters.allocations == 3);
+
+            Vector<Obj, Alloc> v_moved(std::move(v_copy));
+            assert(counters.allocations == 3);
+            assert(v_moved[SIZE].id == ID);
+        }
+        assert(counters.allocations == counters.deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+    {
+        Obj::ResetCounters();
+        Alloc::Counters counters;
+        Alloc::Counters other_counters;
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc(&counters));
+            Vector<Obj, Alloc> other(SIZE / 2, Alloc(&other_counters));
+            other[0].id = ID;
+            // Аллокаторы не равны и не распространяются: память остаётся за своим аллокатором
+            v = std::move(other);
+            assert(v.Size() == SIZE / 2);
+            assert(v[0].id == ID);
+            assert(v.GetAllocator() == Alloc(&counters));
+            assert(other.Size() == 0);
+            assert(Obj::GetAliveObjectCount() == SIZE / 2);
         }
-        return *this;
+        assert(counters.allocations == counters.deallocations);
+        assert(other_counters.allocations == other_counters.deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    {
+        Obj::ResetCounters();
+        using PropagatingAlloc = CopyPropagatingAllocator<Obj>;
+        Alloc::Counters counters;
+        Alloc::Counters other_counters;
+        {
+            Vector<Obj, PropagatingAlloc> v(SIZE, PropagatingAlloc(&counters));
+            Vector<Obj, PropagatingAlloc> other(SIZE / 2, PropagatingAlloc(&other_counters));
+            other[0].id = ID;
+            // Старые элементы освобождаются старым аллокатором, копия выделяется новым
+            v = other;
+            assert(v.Size() == SIZE / 2 && v[0].id == ID);
+            assert(v.GetAllocator() == other.GetAllocator());
+            assert(counters.allocations == counters.deallocations);
+            assert(other_counters.allocations == 2);
+            assert(Obj::GetAliveObjectCount() == SIZE);
+        }
+        assert(other_counters.allocations == other_counters.deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    ~C() {
-        ++dtor;
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v(SIZE);
+            Vector<Obj> other(SIZE / 2);
+            v = std::move(other);
+            assert(v.Size() == SIZE / 2);
+            assert(Obj::GetAliveObjectCount() == SIZE / 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+// Тип с нетривиальными конструкторами, объявленный тривиально перемещаемым
+struct RelocatableObj {
+    explicit RelocatableObj(int id)
+        : id(std::make_unique<int>(id)) {
+    }
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : id(std::move(other.id)) {
+        ++num_moved;
+    }
+    RelocatableObj& operator=(RelocatableObj&& other) noexcept {
+        id = std::move(other.id);
+        ++num_moved;
+        return *this;
     }
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+    std::unique_ptr<int> id;
+    static inline int num_moved = 0;
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {};
+
+void Test8() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        v.Insert(v.cbegin() + 1, v[SIZE - 1]);
+        v.Emplace(v.cbegin(), v[3]);
+        v.Erase(v.cbegin() + 2);
+        const std::vector<int> expected{2, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.cbegin() + 3, std::make_unique<int>(-1));
+        v.Erase(v.cbegin());
+        assert(v.Size() == SIZE);
+        assert(*v[2] == -1);
+        assert(*v[SIZE - 1] == static_cast<int>(SIZE) - 1);
+    }
+    {
+        RelocatableObj::num_moved = 0;
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.cbegin(), static_cast<int>(SIZE));
+        v.Erase(v.cbegin() + 1);
+        assert(RelocatableObj::num_moved == 0);
+        assert(*v[0].id == static_cast<int>(SIZE));
+        assert(*v[1].id == 1);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+void Test9() {
+    const size_t SIZE = 100'000;
+    {
+        // Небольшой порог, чтобы вектор прошёл через realloc, переход на mmap и mremap
+        Vector<int, MallocAllocator<int, 4096>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == SIZE);
+        v.Emplace(v.cbegin() + 1, v[SIZE - 1]);
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        assert(v[0] == 0);
+        assert(v[1] == static_cast<int>(SIZE) - 1);
+        for (size_t i = 2; i < v.Size(); ++i) {
+            assert(v[i] == static_cast<int>(i) - 1);
+        }
+        Vector<int, MallocAllocator<int, 4096>> v_copy(v);
+        assert(std::equal(v.begin(), v.end(), v_copy.begin(), v_copy.end()));
+    }
+    {
+        Vector<std::unique_ptr<int>, MallocAllocator<std::unique_ptr<int>>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Emplace(v.cbegin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1);
+        assert(*v[100] == 99);
+    }
+}
+
+void Test10() {
+    {
+        assert(DoublingGrowth::NextCapacity(0, 1, sizeof(int)) == 1);
+        assert(DoublingGrowth::NextCapacity(8, 9, sizeof(int)) == 16);
+        assert(DoublingGrowth::NextCapacity(8, 100, sizeof(int)) == 100);
+        using Golden = GrowthFactor<3, 2>;
+        assert(Golden::NextCapacity(0, 1, sizeof(int)) == 1);
+        assert(Golden::NextCapacity(1, 2, sizeof(int)) == 2);
+        assert(Golden::NextCapacity(10, 11, sizeof(int)) == 15);
+        assert(SizeClassGrowth<>::RoundToSizeClass(1) == 8);
+        assert(SizeClassGrowth<>::RoundToSizeClass(17) == 32);
+        assert(SizeClassGrowth<>::RoundToSizeClass(129) == 160);
+        assert(SizeClassGrowth<>::RoundToSizeClass(1025) == 1280);
+        // 10 * 1.5 * 4 = 60 байт, класс 64 байта вмещает 16 элементов int
+        assert(SizeClassGrowth<>::NextCapacity(10, 11, sizeof(int)) == 16);
+        assert((PageRoundedGrowth<>::NextCapacity(10, 11, sizeof(int)) == 20));
+        assert((PageRoundedGrowth<>::NextCapacity(1000, 1001, sizeof(int)) == 2048));
+    }
+    {
+        Vector<int, std::allocator<int>, GrowthFactor<3, 2>> v;
+        size_t capacity = v.Capacity();
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+            assert(v.Capacity() >= v.Size());
+            assert(v.Capacity() == capacity || v.Capacity() <= std::max<size_t>(capacity * 3 / 2, capacity + 1));
+            capacity = v.Capacity();
+            assert(v[i] == i);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        CountingAllocator<Obj>::Counters counters;
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            Vector<Obj, CountingAllocator<Obj>> v(1, CountingAllocator<Obj>(&counters));
+            v.Resize(1000);
+            assert(v.Size() == 1000);
+            assert(v.Capacity() == 1000);
+            assert(counters.allocations == 2);
+            assert(Obj::GetAliveObjectCount() == 1000);
         }
-        Dump();
-    } catch (...) {
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+}
+
+void Test11() {
+    const size_t N = 4;
+    const int ID = 42;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        {
+            SmallVector<Obj, N> v;
+            assert(v.Capacity() == N);
+            assert(v.IsInline());
+            for (size_t i = 0; i < N; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(v.IsInline());
+            v.Insert(v.cbegin() + 1, Obj{ID});
+            assert(!v.IsInline());
+            assert(v.Size() == N + 1);
+            assert(v.Capacity() == N * 2);
+            assert(v[1].id == ID);
+            v.Erase(v.cbegin());
+            assert(v[0].id == ID);
+            assert(Obj::GetAliveObjectCount() == N);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            SmallVector<Obj, N> small(N / 2);
+            small[0].id = ID;
+            SmallVector<Obj, N> large(N * 3);
+            large[N].id = ID;
+
+            SmallVector<Obj, N> small_copy(small);
+            assert(small_copy.IsInline());
+            assert(small_copy[0].id == ID);
+            SmallVector<Obj, N> large_copy(large);
+            assert(!large_copy.IsInline());
+            assert(large_copy[N].id == ID);
+
+            const int num_moved = Obj::num_moved;
+            const Obj* large_data = &large[0];
+            SmallVector<Obj, N> large_moved(std::move(large));
+            // Блок из кучи передаётся без перемещения элементов
+            assert(Obj::num_moved == num_moved);
+            assert(&large_moved[0] == large_data);
+            assert(large.Size() == 0);
+            assert(large.IsInline());
+            assert(large.Capacity() == N);
+
+            SmallVector<Obj, N> small_moved(std::move(small));
+            assert(small_moved.IsInline());
+            assert(small_moved.Size() == N / 2);
+            assert(small_moved[0].id == ID);
+
+            small_moved.Swap(large_moved);
+            assert(small_moved.Size() == N * 3);
+            assert(large_moved.Size() == N / 2);
+            assert(large_moved.IsInline());
+            assert(small_moved[N].id == ID);
+
+            small_copy = large_copy;
+            assert(small_copy.Size() == N * 3);
+            large_copy = std::move(large_moved);
+            assert(large_copy.Size() == N / 2);
+            assert(large_copy[0].id == ID);
+            assert(Obj::GetAliveObjectCount() == N * 3 + N * 3 + N / 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        SmallVector<std::string, N> v;
+        for (size_t i = 0; i < N * 4; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Resize(N - 1);
+        v.EmplaceBack("x"s);
+        assert(v.Size() == N);
+        assert(v[N - 1] == "x"s);
+        assert(EraseIf(v, [](const std::string& value) { return value == "x"s; }) == 1);
+        assert(v.Size() == N - 1 && v[N - 2] == std::to_string(N - 2));
+    }
+    // Аллокатор со ссылкой на встроенный буфер не должен попасть в другой вектор через базу
+    using SmallBase = Vector<std::string, InlineAllocator<std::string, N>>;
+    static_assert(!std::is_convertible_v<SmallVector<std::string, N>&, SmallBase&>);
+    static_assert(!std::is_constructible_v<SmallBase, const SmallVector<std::string, N>&>);
+}
+
+void Test12() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        Vector<int> v{1, 2, 3};
+        assert(v.Size() == 3);
+        assert(v.Capacity() == 3);
+        const std::list<int> values{10, 11, 12, 13};
+        auto pos = v.Insert(v.cbegin() + 1, values.begin(), values.end());
+        assert(pos == v.begin() + 1);
+        v.Insert(v.cend(), 2, v[0]);
+        v.Insert(v.cbegin(), {-1, 0});
+        std::istringstream input("7 8 9");
+        v.Append(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        const std::vector<int> expected{-1, 0, 1, 10, 11, 12, 13, 2, 3, 1, 1, 7, 8, 9};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        v.Insert(v.cbegin() + 2, 3, v[0]);
+        assert(v[2] == -1 && v[3] == -1 && v[4] == -1 && v[5] == 1);
+    }
+    {
+        Obj::ResetCounters();
+        CountingAllocator<Obj>::Counters counters;
+        {
+            Vector<Obj, CountingAllocator<Obj>> v(SIZE, CountingAllocator<Obj>(&counters));
+            std::vector<Obj> objs(SIZE * 3);
+            objs[0].id = ID;
+            Obj::ResetCounters();
+            v.Append(objs.begin(), objs.end());
+            // Одно перераспределение на всю пачку
+            assert(counters.allocations == 2);
+            assert(v.Size() == SIZE * 4);
+            assert(v[SIZE].id == ID);
+            assert(Obj::num_copied == static_cast<int>(SIZE * 3));
+            assert(Obj::num_moved == static_cast<int>(SIZE));
+
+            v.Reserve(SIZE * 10);
+            Obj::ResetCounters();
+            v.Insert(v.cbegin() + 1, objs.begin(), objs.begin() + SIZE);
+            assert(v.Size() == SIZE * 5);
+            assert(v[1].id == ID);
+            assert(v[SIZE + 1].id == 0);
+            assert(v[SIZE * 2].id == ID);
+            // Хвост сдвигается один раз, а не на каждый вставленный элемент
+            assert(Obj::num_moved + Obj::num_move_assigned == static_cast<int>(SIZE * 4 - 1));
+            assert(Obj::num_copied + Obj::num_assigned == static_cast<int>(SIZE));
+
+            Obj::ResetCounters();
+            v.Insert(v.cend() - 2, SIZE * 2, v[1]);
+            assert(v.Size() == SIZE * 7);
+            assert(v[SIZE * 5 - 2].id == ID);
+            assert(v[SIZE * 7 - 3].id == ID);
+            assert(v[SIZE * 7 - 2].id == 0);
+        }
+        assert(counters.allocations == counters.deallocations);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v(SIZE);
+            std::vector<Obj> objs(SIZE);
+            objs[SIZE / 2].throw_on_copy = true;
+            try {
+                v.Insert(v.cbegin() + 1, objs.begin(), objs.end());
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == SIZE);
+            assert(v.Capacity() == SIZE);
+            assert(Obj::GetAliveObjectCount() == SIZE * 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(*pos == 5);
+        assert(v.Size() == 7);
+        assert(v.Erase(v.cbegin(), v.cbegin()) == v.begin());
+        assert(EraseIf(v, [](int x) {
+                   return x % 2 == 1;
+               }) == 4);
+        const std::vector<int> expected{0, 6, 8};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        v.SwapErase(v.cbegin());
+        assert(v.Size() == 2 && v[0] == 8 && v[1] == 6);
+        v.SwapErase(v.cbegin() + 1);
+        assert(v.Size() == 1 && v[0] == 8);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v(SIZE);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v[i].id = static_cast<int>(i);
+            }
+            v.Erase(v.cbegin() + 1, v.cbegin() + 4);
+            assert(v.Size() == SIZE - 3);
+            assert(v[1].id == 4);
+            assert(Obj::num_move_assigned == static_cast<int>(SIZE - 4));
+            assert(Obj::GetAliveObjectCount() == SIZE - 3);
+
+            Obj::ResetCounters();
+            EraseIf(v, [](const Obj& obj) {
+                return obj.id > 5;
+            });
+            assert(v.Size() == 3);
+            assert(v[0].id == 0 && v[1].id == 4 && v[2].id == 5);
+            assert(Obj::num_destroyed == 4);
+
+            Obj::ResetCounters();
+            v.SwapErase(v.cbegin());
+            assert(v.Size() == 2);
+            assert(v[0].id == 5 && v[1].id == 4);
+            assert(Obj::num_move_assigned == 1);
+            assert(Obj::num_destroyed == 1);
+        }
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Erase(v.cbegin(), v.cbegin() + 3);
+        v.SwapErase(v.cbegin());
+        assert(v.Size() == SIZE - 4);
+        assert(*v[0] == 9 && *v[1] == 4);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Vector<int> v(SIZE, DEFAULT_INIT);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        std::fill(v.begin(), v.end(), 1);
+        v.ResizeDefaultInit(SIZE * 3);
+        assert(v.Size() == SIZE * 3);
+        assert(v[SIZE - 1] == 1);
+        v.ResizeDefaultInit(SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        assert(v.Capacity() == SIZE * 3);
+    }
+    {
+        Vector<char> buffer{'a', 'b'};
+        std::istringstream input("socket payload");
+        buffer.ResizeAndOverwrite(SIZE, [&input](char* data, size_t size) {
+            input.read(data + 2, static_cast<std::streamsize>(size - 2));
+            return static_cast<size_t>(input.gcount()) + 2;
+        });
+        assert(std::string(buffer.begin(), buffer.end()) == "absocket payload");
+        assert(buffer.Capacity() >= SIZE);
+    }
+    {
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            Vector<Obj> v(SIZE / 2, DEFAULT_INIT);
+            assert(Obj::num_default_constructed == SIZE / 2);
+            v.ResizeAndOverwrite(SIZE, [](Obj* data, size_t size) {
+                for (size_t i = 0; i < size; ++i) {
+                    data[i].id = static_cast<int>(i);
+                }
+                return size / 4;
+            });
+            assert(v.Size() == SIZE / 4);
+            assert(v[SIZE / 4 - 1].id == SIZE / 4 - 1);
+            assert(Obj::GetAliveObjectCount() == SIZE / 4);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        assert(v.BytesAllocated() == SIZE * sizeof(Obj));
+        v.Resize(SIZE / 4);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 4);
+        assert(v.BytesAllocated() == SIZE / 4 * sizeof(Obj));
+        assert(Obj::GetAliveObjectCount() == SIZE / 4);
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE / 4);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.Resize(SIZE / 2);
+        v.Clear(true);
+        assert(v.Capacity() == 0);
+        assert(v.BytesAllocated() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.ShrinkToFit();
+        v.PushBack(Obj{1});
+        assert(v.Size() == 1);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v[SIZE / 4 - 1] = 42;
+        v.Resize(SIZE / 4);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 4);
+        assert(v[SIZE / 4 - 1] == 42);
+    }
+    {
+        const size_t N = 8;
+        SmallVector<int, N> v(SIZE);
+        assert(v.BytesAllocated() == SIZE * sizeof(int));
+        v[1] = 42;
+        v.Resize(N / 2);
+        v.ShrinkToFit();
+        assert(v.IsInline());
+        assert(v.Capacity() == N);
+        assert(v.BytesAllocated() == 0);
+        assert(v[1] == 42);
+        v.Clear(true);
+        assert(v.IsInline());
+        assert(v.Capacity() == N);
+    }
+}
+
+void Test16() {
+    const auto is_aligned = [](const void* ptr, size_t alignment) {
+        return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+    };
+    {
+        Vector<float, AlignedAllocator<float, 64>> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(&v[0], 64));
+        }
+        v.Insert(v.cbegin() + 1, 10, v[0]);
+        assert(is_aligned(&v[0], 64));
+        Vector<float, AlignedAllocator<float, 64>> v_copy(v);
+        assert(is_aligned(&v_copy[0], 64));
+        assert(std::equal(v.begin(), v.end(), v_copy.begin(), v_copy.end()));
+    }
+    {
+        struct alignas(32) Lane {
+            double values[4];
+        };
+        Vector<Lane, AlignedAllocator<Lane, 32>> v(3);
+        assert(is_aligned(&v[0], 32));
+    }
+    {
+        const size_t SIZE = HUGE_PAGE_SIZE;
+        Vector<int, AlignedAllocator<int, 64, HugePages::TRANSPARENT>> v(SIZE);
+        assert(is_aligned(&v[0], HUGE_PAGE_SIZE));
+        v[SIZE - 1] = 42;
+        v.PushBack(1);
+        assert(is_aligned(&v[0], HUGE_PAGE_SIZE));
+        assert(v[SIZE - 1] == 42);
+        Vector<int, AlignedAllocator<int, 64, HugePages::EXPLICIT>> v_explicit(SIZE);
+        v_explicit[SIZE - 1] = 42;
+        assert(is_aligned(&v_explicit[0], HUGE_PAGE_SIZE));
+    }
+}
+
+// Перемещающий конструктор не помечен noexcept, но тип разрешает перемещение при росте
+struct ThrowingMoveObj {
+    ThrowingMoveObj() = default;
+    ThrowingMoveObj(const ThrowingMoveObj& other)
+        : value(other.value)
+    {
+        ++num_copied;
+    }
+    ThrowingMoveObj(ThrowingMoveObj&& other)
+        : value(std::move(other.value))
+    {
+        if (move_throw_countdown > 0 && --move_throw_countdown == 0) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_moved;
+    }
+
+    std::string value;
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int move_throw_countdown = 0;
+};
+
+template <>
+struct MoveEvenIfThrows<ThrowingMoveObj> : std::true_type {};
+
+void Test17() {
+    struct CopiedOnGrowth {
+        CopiedOnGrowth() = default;
+        CopiedOnGrowth(const CopiedOnGrowth&) = default;
+        CopiedOnGrowth(CopiedOnGrowth&& /*other*/) {
+        }
+        std::string value;
+    };
+    static const void* last_container = nullptr;
+    static size_t hook_calls = 0;
+    VectorInstrumentation::ResetStats();
+    VectorInstrumentation::SetReallocationHook([](const ReallocationEvent& event) {
+        last_container = event.container;
+        ++hook_calls;
+        assert(event.new_capacity > event.old_capacity);
+    });
+    {
+        Vector<int> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
         }
-        Dump();
-    } catch (...) {
+        // Вместимость 1 -> 2 -> 4 -> 8: первое выделение переносит 0 элементов
+        const VectorStats stats = VectorInstrumentation::GetStats();
+        assert(stats.reallocations == 4);
+        assert(stats.elements_relocated == 0 + 1 + 2 + 4);
+        assert(stats.elements_moved == 0 && stats.elements_copied == 0);
+        assert(stats.bytes_allocated == (1 + 2 + 4 + 8) * sizeof(int));
+        assert(stats.bytes_freed == (1 + 2 + 4) * sizeof(int));
+        assert(stats.peak_capacity_bytes == 8 * sizeof(int));
+        assert(hook_calls == 4 && last_container == &v);
+    }
+    assert(VectorInstrumentation::GetStats().bytes_freed == (1 + 2 + 4 + 8) * sizeof(int));
+    VectorInstrumentation::ResetStats();
+    {
+        Vector<std::string> strings(3);
+        strings.Reserve(10);
+        Vector<CopiedOnGrowth> copied(3);
+        copied.Reserve(10);
+        const VectorStats stats = VectorInstrumentation::GetStats();
+        assert(stats.reallocations == 2);
+        assert(stats.elements_moved == 3);
+        assert(stats.elements_copied == 3);
+    }
+    VectorInstrumentation::SetReallocationHook(nullptr);
+    VectorInstrumentation::ResetStats();
+    {
+        Vector<int> v(10);
+        v.Reserve(20);
+        assert(VectorInstrumentation::GetStats().reallocations == 1);
+        assert(hook_calls == 6);
+    }
+}
+
+void Test18() {
+    const size_t SIZE = 10;
+    {
+        Vector<ThrowingMoveObj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].value = std::to_string(i);
+        }
+        v.Reserve(SIZE * 2);
+        v.PushBack(v[0]);
+        assert(ThrowingMoveObj::num_copied == 1);
+        assert(ThrowingMoveObj::num_moved == static_cast<int>(SIZE));
+        assert(v[SIZE].value == "0");
+    }
+    {
+        // Исключение при перемещении: вектор остаётся в старом блоке, значения не гарантируются
+        Vector<ThrowingMoveObj> v(SIZE);
+        const size_t capacity = v.Capacity();
+        ThrowingMoveObj::move_throw_countdown = 3;
+        try {
+            v.Reserve(SIZE * 2);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == capacity);
+        v.PushBack(ThrowingMoveObj());
+        assert(v.Size() == SIZE + 1);
+    }
+}
+
+void Test19() {
+    using namespace std::literals;
+    const size_t SIZE = 5;
+    {
+        // Вставка в конец в пределах вместимости создаёт элемент на месте
+        Vector<Obj> v;
+        v.Reserve(SIZE + 1);
+        Obj::ResetCounters();
+        v.Emplace(v.cend(), 1, "one"s);
+        assert(Obj::num_constructed_with_id_and_name == 1);
+        assert(Obj::num_moved == 0 && Obj::num_move_assigned == 0 && Obj::num_destroyed == 0);
+    }
+    {
+        // Вставка значения в середину: один сдвиг хвоста и одно присваивание, без временного объекта
+        Vector<Obj> v;
+        v.Reserve(SIZE + 1);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        Obj::ResetCounters();
+        v.Insert(v.cbegin() + 1, Obj(42));
+        assert(Obj::num_moved == 1);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE) - 1);
+        assert(Obj::num_destroyed == 1);
+        assert(v[1].id == 42 && v[2].id == 1 && v[SIZE].id == static_cast<int>(SIZE) - 1);
+        v.PopBack();
+        // Вставляемое значение ссылается на элемент, который сдвигается
+        Obj::ResetCounters();
+        v.Insert(v.cbegin(), v[3]);
+        assert(Obj::num_copied == 0 && Obj::num_assigned == 1);
+        assert(v[0].id == 2 && v[1].id == 0 && v[4].id == 2);
+    }
+    {
+        Vector<std::string> v{"a"s, "b"s, "c"s};
+        v.Reserve(10);
+        v.Insert(v.cbegin() + 1, v[2]);
+        v.Emplace(v.cbegin(), 3, 'x');
+        v.Insert(v.cbegin() + 2, v[0]);
+        const std::vector<std::string> expected{"xxx"s, "a"s, "xxx"s, "c"s, "b"s, "c"s};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+    }
+}
+
+template <typename T>
+void CheckSimdAlgorithms() {
+    const size_t MAX_SIZE = 300;
+    const size_t MAX_OFFSET = 8;
+    std::vector<T> values(MAX_SIZE + MAX_OFFSET);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<T>((i * 7919) % 61) - static_cast<T>(20);
+    }
+    // Смещения от начала проверяют невыровненные головы, размеры — хвосты
+    for (size_t offset = 0; offset < MAX_OFFSET; ++offset) {
+        for (size_t size = 0; size <= MAX_SIZE; size += 1 + size / 8) {
+            const T* data = values.data() + offset;
+            const T needle = values[offset + size / 2];
+            assert(Simd::Find(data, size, needle) == static_cast<size_t>(std::find(data, data + size, needle) - data));
+            assert(Simd::Count(data, size, needle) == static_cast<size_t>(std::count(data, data + size, needle)));
+            T sum{};
+            for (size_t i = 0; i < size; ++i) {
+                sum += data[i];
+            }
+            assert(Simd::Sum(data, size) == sum);
+            if (size != 0) {
+                assert(Simd::Min(data, size) == *std::min_element(data, data + size));
+                assert(Simd::Max(data, size) == *std::max_element(data, data + size));
+            }
+            std::vector<T> out(size + MAX_OFFSET, T(1));
+            Simd::Add(data, data, size, out.data() + offset % 3);
+            Simd::Mul(out.data() + offset % 3, data, size, out.data() + offset % 3);
+            for (size_t i = 0; i < size; ++i) {
+                assert(out[offset % 3 + i] == static_cast<T>((data[i] + data[i]) * data[i]));
+            }
+            Simd::Fill(out.data() + offset, size, T(3));
+            assert(Simd::Count(out.data() + offset, size, T(3)) == size);
+        }
+    }
+    Vector<T, AlignedAllocator<T, 64>> v(values.size());
+    Simd::Fill(v, 5);
+    assert(Simd::Count(v, 5) == v.Size());
+    Vector<T, AlignedAllocator<T, 64>> copy;
+    Simd::Copy(v, copy);
+    copy[10] = 7;
+    assert(Simd::Find(copy, 7) == copy.begin() + 10);
+    assert(Simd::Max(copy) == 7 && Simd::Min(copy) == 5);
+    Simd::Add(v, copy, v);
+    assert(Simd::Sum(v) == static_cast<T>(10 * v.Size() + 2));
+}
+
+void Test20() {
+    const SimdLevel detected = Simd::Level();
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::NEON, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (!Simd::SetLevel(level)) {
+            continue;
+        }
+        CheckSimdAlgorithms<int8_t>();
+        CheckSimdAlgorithms<uint16_t>();
+        CheckSimdAlgorithms<int32_t>();
+        CheckSimdAlgorithms<int64_t>();
+        CheckSimdAlgorithms<float>();
+        CheckSimdAlgorithms<double>();
+    }
+    Simd::SetLevel(detected);
+    {
+        // Count не переполняет 8-битные счётчики дорожек
+        Vector<uint8_t> v(100000);
+        Simd::Fill(v, 1);
+        assert(Simd::Count(v, 1) == v.Size());
+        assert(Simd::Sum(v) == static_cast<uint8_t>(v.Size()));
+    }
+}
+
+// Счётчики общие для потоков, в отличие от Obj
+struct SharedCountedObj {
+    SharedCountedObj() {
+        if (default_construction_throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+    SharedCountedObj(const SharedCountedObj& other)
+        : value(other.value)
+    {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+    ~SharedCountedObj() {
+        --num_alive;
+    }
+
+    std::string value;
+    bool throw_on_copy = false;
+    static inline std::atomic<int> num_alive{0};
+    static inline std::atomic<int> default_construction_throw_countdown{0};
+};
+
+void Test21() {
+    const size_t SIZE = 10000;
+    const ParallelPolicy policy{4, 100};
+    {
+        Vector<SharedCountedObj> v(SIZE, policy);
+        assert(v.Size() == SIZE && SharedCountedObj::num_alive == static_cast<int>(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].value = std::to_string(i);
+        }
+        Vector<SharedCountedObj> copy(v, policy);
+        assert(SharedCountedObj::num_alive == static_cast<int>(2 * SIZE));
+        copy.Reserve(SIZE * 2, policy);
+        assert(copy.Capacity() == SIZE * 2 && SharedCountedObj::num_alive == static_cast<int>(2 * SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(copy[i].value == std::to_string(i));
+        }
+        // Ошибка копирования в одной из частей: все созданные копии уничтожены, вектор не изменился
+        v[SIZE - 10].throw_on_copy = true;
+        try {
+            Vector<SharedCountedObj> failed(v, policy);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(SharedCountedObj::num_alive == static_cast<int>(2 * SIZE));
+        try {
+            v.Reserve(SIZE * 2, policy);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == SIZE && v[0].value == "0" && v[SIZE - 1].value == std::to_string(SIZE - 1));
+        assert(SharedCountedObj::num_alive == static_cast<int>(2 * SIZE));
+        copy.Clear(policy, true);
+        assert(copy.Size() == 0 && copy.Capacity() == 0);
+        assert(SharedCountedObj::num_alive == static_cast<int>(SIZE));
+    }
+    assert(SharedCountedObj::num_alive == 0);
+    {
+        SharedCountedObj::default_construction_throw_countdown = SIZE / 2;
+        try {
+            Vector<SharedCountedObj> v(SIZE, policy);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        SharedCountedObj::default_construction_throw_countdown = 0;
+        assert(SharedCountedObj::num_alive == 0);
+    }
+    {
+        Vector<int> v(SIZE, policy);
+        assert(std::count(v.begin(), v.end(), 0) == static_cast<int>(SIZE));
+        std::iota(v.begin(), v.end(), 0);
+        v.Reserve(SIZE * 3, policy);
+        assert(v.Capacity() == SIZE * 3 && v[SIZE - 1] == static_cast<int>(SIZE) - 1);
+        // Малые векторы обрабатываются без запуска потоков
+        Vector<std::string> small(10, PARALLEL);
+        small.Reserve(20, PARALLEL);
+        assert(small.Size() == 10 && small.Capacity() == 20);
+    }
+}
+
+void Test22() {
+    const size_t NUM_THREADS = 8;
+    const size_t PER_THREAD = 5000;
+    {
+        ConcurrentVector<uint64_t> cv;
+        std::vector<std::vector<const uint64_t*>> addresses(NUM_THREADS);
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            producers.emplace_back([&cv, &addresses, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    addresses[t].push_back(&cv.EmplaceBack(t * PER_THREAD + i));
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        assert(cv.Size() == NUM_THREADS * PER_THREAD);
+        // Адреса не изменились после роста
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            for (size_t i = 0; i < PER_THREAD; ++i) {
+                assert(*addresses[t][i] == t * PER_THREAD + i);
+            }
+        }
+        Vector<uint64_t> frozen = cv.Freeze();
+        assert(cv.Size() == 0);
+        assert(frozen.Size() == NUM_THREADS * PER_THREAD);
+        std::sort(frozen.begin(), frozen.end());
+        for (size_t i = 0; i < frozen.Size(); ++i) {
+            assert(frozen[i] == i);
+        }
+    }
+    {
+        // Исключение в одном из конструкторов оставляет пустую позицию, которую Freeze пропускает
+        ConcurrentVector<SharedCountedObj> cv;
+        SharedCountedObj::default_construction_throw_countdown = PER_THREAD;
+        std::atomic<size_t> num_failed{0};
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            producers.emplace_back([&cv, &num_failed] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    try {
+                        cv.EmplaceBack();
+                    } catch (const std::runtime_error&) {
+                        ++num_failed;
+                    }
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        SharedCountedObj::default_construction_throw_countdown = 0;
+        assert(num_failed == 1);
+        assert(SharedCountedObj::num_alive == static_cast<int>(NUM_THREADS * PER_THREAD - 1));
+        Vector<SharedCountedObj> frozen = cv.Freeze();
+        assert(frozen.Size() == NUM_THREADS * PER_THREAD - 1);
+        assert(SharedCountedObj::num_alive == static_cast<int>(frozen.Size()));
+        cv.PushBack(frozen[0]);
+        assert(cv.Size() == 1 && SharedCountedObj::num_alive == static_cast<int>(frozen.Size()) + 1);
+    }
+    assert(SharedCountedObj::num_alive == 0);
+    {
+        ConcurrentVector<std::string> cv;
+        for (size_t i = 0; i < 100; ++i) {
+            cv.PushBack(std::to_string(i));
+        }
+        assert(cv[0] == "0" && cv[31] == "31" && cv[32] == "32" && cv[99] == "99");
+        Vector<std::string> frozen = cv.Freeze();
+        assert(frozen.Size() == 100 && frozen[99] == "99");
+    }
+    {
+        // Пустые позиции в начале сегментов 1 и 2
+        ConcurrentVector<SharedCountedObj> cv;
+        const size_t SIZE = 120;
+        for (size_t i = 0; i < SIZE; ++i) {
+            SharedCountedObj source;
+            source.value = std::to_string(i);
+            source.throw_on_copy = i == 32 || i == 96;
+            try {
+                cv.PushBack(source);
+            } catch (const std::runtime_error&) {
+                assert(i == 32 || i == 96);
+            }
+        }
+        assert(cv.Size() == SIZE && SharedCountedObj::num_alive == static_cast<int>(SIZE - 2));
+        Vector<SharedCountedObj> frozen = cv.Freeze();
+        assert(frozen.Size() == SIZE - 2);
+        for (size_t i = 0, pos = 0; i < SIZE; ++i) {
+            if (i != 32 && i != 96) {
+                assert(frozen[pos++].value == std::to_string(i));
+            }
+        }
+    }
+    assert(SharedCountedObj::num_alive == 0);
+}
+
+void Test23() {
+    using namespace std::literals;
+    {
+        Arena arena(4096);
+        ArenaAllocator<int> alloc(arena);
+        Vector<int, ArenaAllocator<int>> v(alloc);
+        v.PushBack(0);
+        const int* data = &v[0];
+        // Вектор на вершине арены растёт на месте
+        for (int i = 1; i < 200; ++i) {
+            v.PushBack(i);
+        }
+        assert(&v[0] == data);
+        assert(arena.BytesReserved() == 4096);
+        // Другая аллокация закрывает вершину: следующий рост переносит элементы
+        Vector<int, ArenaAllocator<int>> other(10, alloc);
+        v.Reserve(v.Capacity() + 1);
+        assert(&v[0] != data);
+        for (int i = 0; i < 200; ++i) {
+            assert(v[i] == i);
+        }
+        // Нетривиально перемещаемые элементы тоже растут на месте
+        Vector<std::string, ArenaAllocator<std::string>> strings(alloc);
+        strings.PushBack("a"s);
+        const std::string* first = &strings[0];
+        for (int i = 0; i < 10; ++i) {
+            strings.Insert(strings.cbegin(), strings[strings.Size() - 1]);
+        }
+        assert(&strings[0] == first && strings.Size() == 11);
+        assert(std::count(strings.begin(), strings.end(), "a"s) == 11);
+    }
+    {
+        Arena arena(256);
+        ArenaAllocator<std::string> alloc(arena);
+        for (int round = 0; round < 3; ++round) {
+            {
+                Vector<std::string, ArenaAllocator<std::string>> v(alloc);
+                for (int i = 0; i < 100; ++i) {
+                    v.EmplaceBack(std::to_string(i));
+                }
+                assert(v[99] == "99");
+            }
+            const size_t reserved = arena.BytesReserved();
+            arena.Reset();
+            // После сброса остаётся только последний, самый большой блок
+            assert(arena.BytesReserved() <= reserved);
+            assert(round == 0 || arena.BytesReserved() == reserved);
+        }
+    }
+    {
+        // Блок размером ровно под первую аллокацию: выравнивание второй уходит за его конец
+        Arena arena;
+        const size_t BIG = 200001;
+        char* big = static_cast<char*>(arena.Allocate(BIG, 1));
+        const size_t reserved = arena.BytesReserved();
+        int* small = static_cast<int*>(arena.Allocate(sizeof(int), alignof(int)));
+        assert(reinterpret_cast<std::uintptr_t>(small) % alignof(int) == 0);
+        assert(arena.BytesReserved() > reserved);
+        *small = 1;
+        big[BIG - 1] = 1;
+        assert(reinterpret_cast<char*>(small) < big || reinterpret_cast<char*>(small) >= big + BIG);
+    }
+    {
+        ArenaVector<Obj> v;
+        assert(&v.GetAllocator().GetArena() == &ThreadArena());
+        v.EmplaceBack(1);
+        v.Emplace(v.cbegin(), v[0]);
+        assert(v.Size() == 2 && v[0].id == 1 && v[1].id == 1);
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+void Test24() {
+    struct Record {
+        uint64_t key;
+        double value;
+    };
+    char path[] = "/tmp/mapped_vector_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    const size_t SIZE = 10000;
+    {
+        MappedVector<Record> v(path, MapMode::READ_WRITE);
+        assert(v.Size() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack({i, i * 0.5});
+        }
+        assert(v.Capacity() * sizeof(Record) % 4096 == 0);
+        v.Flush();
+    }
+    {
+        // Файл обрезан до размера вектора и читается без копирования
+        MappedVector<Record> v(path, MapMode::READ_ONLY);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        v.Advise(MapAdvice::SEQUENTIAL);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].key == i && v[i].value == i * 0.5);
+        }
+    }
+    {
+        // Приватные изменения и рост не попадают в файл
+        MappedVector<Record> v(path, MapMode::COPY_ON_WRITE);
+        v[0].key = 42;
+        v.Resize(SIZE * 2);
+        assert(v[0].key == 42 && v[SIZE - 1].key == SIZE - 1 && v[SIZE * 2 - 1].key == 0);
+        MappedVector<Record> reader(path, MapMode::READ_ONLY);
+        assert(reader.Size() == SIZE && reader[0].key == 0);
+        // Отбрасывание страниц стёрло бы приватные изменения
+        try {
+            v.Advise(MapAdvice::DONT_NEED);
+            assert(false);
+        } catch (const std::system_error& e) {
+            assert(e.code() == std::errc::invalid_argument);
+        }
+        assert(v[0].key == 42);
+    }
+    {
+        MappedVector<Record> v(path, MapMode::READ_WRITE);
+        v[1].key = 7;
+        const Record extra[] = {{1, 1.0}, {2, 2.0}};
+        v.Append(extra, 2);
+        MappedVector<Record> moved(std::move(v));
+        assert(v.Size() == 0 && moved.Size() == SIZE + 2);
+        // Общее отображение: изменения сразу видны другим отображениям файла
+        MappedVector<Record> reader(path, MapMode::READ_ONLY);
+        assert(reader[1].key == 7 && reader.Size() >= SIZE + 2);
+        // В общем отображении отброшенные страницы перечитываются из файла
+        moved.Advise(MapAdvice::DONT_NEED, 1, 1);
+        assert(moved[1].key == 7 && moved[0].key == 0);
+    }
+    {
+        MappedVector<Record> v(path, MapMode::READ_ONLY);
+        assert(v.Size() == SIZE + 2 && v[SIZE + 1].key == 2);
+    }
+    std::remove(path);
+    try {
+        MappedVector<Record> missing("/nonexistent/mapped_vector", MapMode::READ_ONLY);
+        assert(false);
+    } catch (const std::system_error& e) {
+        assert(e.code() == std::errc::no_such_file_or_directory);
+    }
+}
+#endif
+
+void Test25() {
+    struct Point {
+        int32_t x;
+        int32_t y;
+        double weight;
+    };
+    Vector<Point> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.PushBack(Point{i, -i, i * 0.25});
+    }
+    {
+        // Буфер, выровненный для Point, как у mmap или recv в подходящую память
+        Vector<uint64_t> storage((SerializedSize(points) + 7) / 8);
+        void* buffer = storage.begin();
+        Serialize(points, buffer);
+        const SerializedView<Point> view = DeserializeView<Point>(buffer, SerializedSize(points));
+        assert(view.Size() == points.Size());
+        assert(static_cast<const void*>(view.Data()) == static_cast<unsigned char*>(buffer) + sizeof(SerializedHeader));
+        for (size_t i = 0; i < view.Size(); ++i) {
+            assert(view[i].x == points[i].x && view[i].y == points[i].y && view[i].weight == points[i].weight);
+        }
+        const Vector<Point> copy = Deserialize<Point>(buffer, SerializedSize(points));
+        assert(copy.Size() == points.Size() && copy[999].y == -999);
+
+        try {
+            DeserializeView<int64_t>(buffer, SerializedSize(points));
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        try {
+            Deserialize<Point>(buffer, SerializedSize(points) - 1);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        static_cast<unsigned char*>(buffer)[0] = 'X';
+        try {
+            Deserialize<Point>(buffer, SerializedSize(points));
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+    }
+    {
+        const Vector<char> empty;
+        Vector<char> buffer(64);
+        assert(SerializedSize(empty) == sizeof(SerializedHeader));
+        Serialize(empty, buffer.Data());
+        assert(Deserialize<char>(buffer.Data(), SerializedSize(empty)).Size() == 0);
+    }
+#if defined(VECTOR_SERIALIZATION_FD)
+    {
+        char path[] = "/tmp/serialized_vector_XXXXXX";
+        const int fd = mkstemp(path);
+        assert(fd >= 0);
+        Serialize(points, fd);
+        Vector<int> numbers(50000);
+        std::iota(numbers.begin(), numbers.end(), 0);
+        Serialize(numbers, fd);
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        const Vector<Point> read_points = Deserialize<Point>(fd);
+        const Vector<int> read_numbers = Deserialize<int>(fd);
+        assert(read_points.Size() == points.Size() && read_points[500].x == 500 && read_points[500].weight == 125.0);
+        assert(read_numbers.Size() == numbers.Size() && std::equal(numbers.begin(), numbers.end(), read_numbers.begin()));
+        try {
+            Deserialize<int>(fd);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        // Заголовок обещает больше элементов, чем есть в файле: ошибка до выделения памяти
+        const SerializedHeader huge = MakeSerializedHeader<int>(size_t(1) << 40);
+        assert(ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0);
+        assert(write(fd, &huge, sizeof(huge)) == static_cast<ssize_t>(sizeof(huge)));
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        try {
+            Deserialize<int>(fd);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        close(fd);
+        std::remove(path);
+    }
+    {
+        // Через канал длина неизвестна: буфер растёт по мере чтения
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        Vector<int> numbers(100000);
+        std::iota(numbers.begin(), numbers.end(), 0);
+        std::thread writer([&numbers, fd = pipe_fds[1]] {
+            Serialize(numbers, fd);
+            Serialize(Vector<int>(10), fd);
+            // Поддельный заголовок и несколько элементов, затем конец данных
+            const SerializedHeader huge = MakeSerializedHeader<int>(size_t(1) << 40);
+            assert(write(fd, &huge, sizeof(huge)) == static_cast<ssize_t>(sizeof(huge)));
+            assert(write(fd, numbers.Data(), 100) == 100);
+            close(fd);
+        });
+        const Vector<int> read_numbers = Deserialize<int>(pipe_fds[0]);
+        assert(read_numbers.Size() == numbers.Size() && std::equal(numbers.begin(), numbers.end(), read_numbers.begin()));
+        assert(Deserialize<int>(pipe_fds[0]).Size() == 10);
+        try {
+            Deserialize<int>(pipe_fds[0]);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        writer.join();
+        close(pipe_fds[0]);
+        // Обрезанный заголовок
+        const SerializedHeader header = MakeSerializedHeader<int>(1);
+        assert(pipe(pipe_fds) == 0);
+        assert(write(pipe_fds[1], &header, sizeof(header) / 2) == static_cast<ssize_t>(sizeof(header) / 2));
+        close(pipe_fds[1]);
+        try {
+            Deserialize<int>(pipe_fds[0]);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        close(pipe_fds[0]);
+    }
+#endif
+}
+
+void Test26() {
+    Obj::ResetCounters();
+    {
+        SoAVector<int, double, std::string, Obj> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, i * 0.5, std::to_string(i), i);
+        }
+        assert(v.Size() == 100 && v.Capacity() >= 100);
+        assert(Obj::GetAliveObjectCount() == 100);
+        // Горячий цикл читает только столбец id
+        ColumnSpan<const int> ids = std::as_const(v).Column<0>();
+        assert(std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+        for (auto [id, weight, name, obj] : v) {
+            assert(weight == id * 0.5 && name == std::to_string(id) && obj.id == id);
+            weight = -1.0;
+        }
+        assert(v.Column<1>()[7] == -1.0);
+        std::get<2>(v[3]) = "three";
+        assert(v.Column<2>()[3] == "three");
+
+        // Аргументы ссылаются на поля строки, которая переедет при росте
+        {
+            SoAVector<int, double, std::string, Obj> full(v);
+            assert(full.Capacity() == 100);
+            full.EmplaceBack(full.Column<0>()[3], 0.0, full.Column<2>()[3], Obj(1));
+            assert(full.Capacity() > 100 && std::get<2>(full[100]) == "three" && std::get<0>(full[100]) == 3);
+        }
+        v.EmplaceBack(3, 0.0, "three", Obj(1));
+
+        auto it = v.Erase(v.begin() + 10);
+        assert(std::get<0>(*it) == 11 && v.Size() == 100);
+        it = v.Erase(v.begin() + 20, v.begin() + 30);
+        assert(std::get<0>(*it) == 31 && v.Size() == 90);
+        assert(std::get<3>(v[19]).id == 20 && std::get<2>(v[20]) == "31");
+        assert(Obj::GetAliveObjectCount() == 90);
+
+        const SoAVector<int, double, std::string, Obj> copy(v);
+        assert(copy.Size() == v.Size() && std::get<2>(copy[3]) == "three" && std::get<3>(copy[89]).id == 1);
+        v.Resize(95);
+        assert(std::get<0>(v[94]) == 0 && std::get<2>(v[94]).empty());
+        v.PopBack();
+        v.PushBack({7, 7.0, "seven", Obj(7)});
+        assert(std::get<2>(v[94]) == "seven" && Obj::GetAliveObjectCount() == 95 + 90);
+        v.Clear();
+        assert(v.Size() == 0 && Obj::GetAliveObjectCount() == 90);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Столбец, который при росте копируется, переносится первым: если копия не удалась,
+        // остальные столбцы ещё не тронуты
+        SharedCountedObj::num_alive = 0;
+        SoAVector<std::string, SharedCountedObj> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(std::to_string(i), SharedCountedObj());
+        }
+        std::get<1>(v[2]).throw_on_copy = true;
+        try {
+            v.EmplaceBack("4", SharedCountedObj());
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v.Capacity() == 4 && SharedCountedObj::num_alive == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(std::get<0>(v[i]) == std::to_string(i));
+        }
+    }
+    assert(SharedCountedObj::num_alive == 0);
+}
+
+constexpr StaticVector<int, 16> MakeSquares() {
+    StaticVector<int, 16> squares;
+    for (int i = 0; i < 16; ++i) {
+        squares.PushBack(i * i);
+    }
+    return squares;
+}
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+// Vector используется при вычислении и освобождается до его окончания
+constexpr int SumOfSquares(int n) {
+    Vector<int> v;
+    for (int i = 0; i < n; ++i) {
+        v.PushBack(i * i);
+    }
+    Vector<int> copy = v;
+    copy.Resize(n + 5);
+    copy.PopBack();
+    v.Clear();
+    int sum = 0;
+    for (int x : copy) {
+        sum += x;
+    }
+    return sum + static_cast<int>(v.Size());
+}
+
+constexpr size_t TotalLength() {
+    Vector<std::string> words{"compile", "time"};
+    words.EmplaceBack(3, 'x');
+    words.Reserve(100);
+    Vector<std::string> moved = std::move(words);
+    size_t length = 0;
+    for (const std::string& word : moved) {
+        length += word.size();
+    }
+    return length + words.Size();
+}
+
+// Таблица простых чисел, построенная при компиляции решетом на Vector
+constexpr StaticVector<int, 25> PRIMES = [] {
+    Vector<bool> is_composite(100);
+    StaticVector<int, 25> primes;
+    for (int i = 2; i < 100; ++i) {
+        if (!is_composite[i]) {
+            primes.PushBack(i);
+            for (int j = i * i; j < 100; j += i) {
+                is_composite[j] = true;
+            }
+        }
+    }
+    return primes;
+}();
+#endif
+
+void Test27() {
+    {
+        constexpr StaticVector<int, 16> SQUARES = MakeSquares();
+        static_assert(SQUARES.Size() == 16 && SQUARES[15] == 225);
+        constexpr StaticVector<int, 4> SMALL{1, 2, 3};
+        static_assert(SMALL.Size() == 3 && SMALL[2] == 3 && SMALL.Capacity() == 4);
+        assert(std::accumulate(SQUARES.begin(), SQUARES.end(), 0) == 1240);
+    }
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+    static_assert(SumOfSquares(10) == 285);
+    static_assert(TotalLength() == 14);
+    static_assert(PRIMES.Size() == 25 && PRIMES[0] == 2 && PRIMES[24] == 97);
+    // Те же функции работают и во время выполнения
+    assert(SumOfSquares(10) == 285 && TotalLength() == 14);
+#endif
+    {
+        StaticVector<std::string, 3> v{"a", "b"};
+        v.EmplaceBack(2, 'c');
+        assert(v.Size() == 3 && v[2] == "cc");
+        try {
+            v.PushBack("d");
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        StaticVector<std::string, 3> copy(v);
+        v.Erase(v.begin());
+        assert(v.Size() == 2 && v[0] == "b" && v[1] == "cc");
+        assert(copy.Size() == 3 && copy[0] == "a");
+        copy = std::move(v);
+        assert(copy.Size() == 2 && copy[1] == "cc");
+        copy.Resize(3);
+        assert(copy[2].empty());
+        copy.Clear();
+        assert(copy.Size() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 8> v;
+            v.EmplaceBack(1);
+            v.EmplaceBack(2);
+            const StaticVector<Obj, 8> copy = v;
+            v.PopBack();
+            assert(Obj::GetAliveObjectCount() == 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test28() {
+    {
+        Vector<int> v{1, 2, 3};
+        assert(v.Data() == v.begin() && std::as_const(v).Data() == v.begin());
+#if defined(__cpp_lib_span)
+        static_assert(std::is_convertible_v<Vector<int>&, std::span<int>>);
+        static_assert(std::is_convertible_v<const Vector<int>&, std::span<const int>>);
+        const std::span<int> span = v;
+        assert(span.data() == v.Data() && span.size() == 3);
+        const std::span<const int> const_span = std::as_const(v);
+        assert(const_span.back() == 3);
+#endif
+    }
+    {
+        // Чужой буфер используется без копирования, пока в нём хватает места
+        static int num_deleted = 0;
+        int* buffer = static_cast<int*>(std::malloc(8 * sizeof(int)));
+        for (int i = 0; i < 5; ++i) {
+            buffer[i] = i;
+        }
+        num_deleted = 0;
+        {
+            Vector<int> v;
+            v.PushBack(42);
+            v.Adopt(buffer, 5, 8, [](int* ptr, size_t capacity) {
+                assert(capacity == 8);
+                std::free(ptr);
+                ++num_deleted;
+            });
+            assert(v.Size() == 5 && v.Capacity() == 8 && v.Data() == buffer && v[4] == 4);
+            v.PushBack(5);
+            v.PushBack(6);
+            v.PushBack(7);
+            assert(v.Data() == buffer && num_deleted == 0);
+            v.PushBack(8);
+            assert(v.Data() != buffer && num_deleted == 1 && v[8] == 8 && v[0] == 0);
+        }
+        assert(num_deleted == 1);
+    }
+    {
+        // Буфер, отданный одним вектором, принимается другим без копирования
+        Vector<std::string> source{"a", "b", "c"};
+        const std::string* data = source.Data();
+        VectorBuffer<std::string> buffer = source.Release();
+        assert(source.Size() == 0 && source.Capacity() == 0 && buffer.data == data && buffer.size == 3);
+        Vector<std::string> target;
+        target.Adopt(buffer.data, buffer.size, buffer.capacity, std::move(buffer.deleter));
+        assert(target.Data() == data && target[2] == "c");
+        target.ShrinkToFit();
+        target.Clear(true);
+        assert(target.Capacity() == 0);
+    }
+    {
+        // Блок, выросший бы через reallocate, переносится из чужого буфера копированием
+        int* buffer = static_cast<int*>(std::malloc(4 * sizeof(int)));
+        buffer[0] = 7;
+        Vector<int, MallocAllocator<int>> v;
+        v.Adopt(buffer, 1, 4, [](int* ptr, size_t /*capacity*/) {
+            std::free(ptr);
+        });
+        v.Reserve(100);
+        assert(v.Capacity() == 100 && v[0] == 7);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v;
+            v.EmplaceBack(1);
+            v.EmplaceBack(2);
+            VectorBuffer<Obj> buffer = v.Release();
+            assert(Obj::GetAliveObjectCount() == 2);
+            Vector<Obj> w;
+            w.EmplaceBack(3);
+            w.Adopt(buffer.data, buffer.size, buffer.capacity, buffer.deleter);
+            assert(Obj::GetAliveObjectCount() == 2 && w[1].id == 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // SmallVector отдаёт элементы из встроенного буфера через блок из кучи
+        Obj::ResetCounters();
+        {
+            VectorBuffer<Obj> buffer;
+            {
+                SmallVector<Obj, 4> small;
+                small.EmplaceBack(1);
+                small.EmplaceBack(2);
+                buffer = small.Release();
+                assert(small.Size() == 0 && small.IsInline() && small.Capacity() == 4);
+                assert(buffer.size == 2 && buffer.data != small.Data());
+                small.EmplaceBack(3);
+                assert(small.IsInline());
+            }
+            assert(buffer.data[1].id == 2 && Obj::GetAliveObjectCount() == 2);
+            // Принятый блок освобождает встроенный буфер, и после Clear(true) вектор возвращается в него
+            SmallVector<Obj, 4> other;
+            other.EmplaceBack(4);
+            other.Adopt(buffer.data, buffer.size, buffer.capacity, buffer.deleter);
+            assert(!other.IsInline() && other.Size() == 2 && other[0].id == 1);
+            assert(Obj::GetAliveObjectCount() == 2);
+            other.Clear(true);
+            assert(other.IsInline() && other.Capacity() == 4);
+            other.EmplaceBack(5);
+            assert(other.IsInline());
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Сериализованные данные, прочитанные в буфер, становятся вектором без копирования
+        Vector<double> values{0.5, 1.5, 2.5};
+        const size_t size = SerializedSize(values) + 2 * sizeof(double);
+        void* buffer = std::malloc(size);
+        Serialize(values, buffer);
+        Vector<double> adopted = DeserializeAdopt<double>(buffer, size, [](void* ptr) {
+            std::free(ptr);
+        });
+        assert(adopted.Size() == 3 && adopted.Capacity() == 5 && adopted[2] == 2.5);
+        assert(static_cast<void*>(adopted.Data()) == static_cast<unsigned char*>(buffer) + sizeof(SerializedHeader));
+        adopted.PushBack(3.5);
+        assert(static_cast<void*>(adopted.Data()) == static_cast<unsigned char*>(buffer) + sizeof(SerializedHeader));
+    }
+}
+
+void Test29() {
+    static_assert(DefaultSegmentSize<char>() == 65536 && DefaultSegmentSize<int>() == 16384);
+    Obj::ResetCounters();
+    {
+        SegmentedVector<Obj, std::allocator<Obj>, 16> v;
+        v.EmplaceBack(0);
+        const Obj* first = &v[0];
+        for (int i = 1; i < 1000; ++i) {
+            v.EmplaceBack(i);
+        }
+        // Рост не переносит элементы
+        assert(&v[0] == first && v.Size() == 1000 && v.Capacity() == 1008);
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(v[999].id == 999 && (v.begin() + 500)->id == 500);
+
+        // Аргумент ссылается на элемент вектора, и сегмент при этом заполнен
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(1);
+        }
+        v.EmplaceBack(v[3]);
+        assert(v[v.Size() - 1].id == 3 && Obj::num_copied == 1);
+
+        const SegmentedVector<Obj, std::allocator<Obj>, 16> copy(v);
+        assert(copy.Size() == v.Size() && copy[998].id == v[998].id);
+        const size_t alive = static_cast<size_t>(Obj::GetAliveObjectCount());
+        assert(alive == 2 * v.Size());
+
+        Obj::default_construction_throw_countdown = 10;
+        try {
+            v.Resize(v.Size() + 20);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(static_cast<size_t>(Obj::GetAliveObjectCount()) == alive);
+
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 16 && v[9].id == 9);
+        v.Clear(true);
+        assert(v.Capacity() == 0 && v.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SegmentedVector<int> v;
+        for (int i = 0; i < 100000; ++i) {
+            v.PushBack(100000 - i);
+        }
+        assert(v.Capacity() == 7 * SegmentedVector<int>::SEGMENT_SIZE);
+        std::sort(v.begin(), v.end());
+        assert(std::is_sorted(v.cbegin(), v.cend()) && v[0] == 1 && v[99999] == 100000);
+        long long sum = 0;
+        v.ForEachRange([&sum](const int* first, size_t count) {
+            sum += std::accumulate(first, first + count, 0LL);
+        });
+        assert(sum == 100000LL * 100001 / 2);
+        SegmentedVector<int> moved(std::move(v));
+        assert(v.Size() == 0 && moved.Size() == 100000);
+        v = moved;
+        assert(v.Size() == 100000 && v[500] == 501);
+    }
+}
+
+void Test30() {
+    Obj::ResetCounters();
+    {
+        IncrementalVector<Obj> v;
+        // Ни один EmplaceBack не переносит больше MigrationStep() элементов
+        for (int i = 0; i < 1000; ++i) {
+            const int moved_before = Obj::num_moved;
+            v.EmplaceBack(i);
+            assert(static_cast<size_t>(Obj::num_moved - moved_before) <= v.MigrationStep());
+        }
+        assert(v.Size() == 1000 && Obj::num_copied == 0);
+        for (int i = 0; i < 1000; ++i) {
+            assert(v[i].id == i);
+        }
+        // Перенос заканчивается раньше, чем заполняется новый блок
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(1);
+        }
+        assert(!v.IsMigrating() && v.BytesAllocated() == v.Capacity() * sizeof(Obj));
+
+        // Аргумент ссылается на элемент, который остаётся в старом блоке
+        v.EmplaceBack(v[v.Size() - 1]);
+        assert(v.IsMigrating() && v[v.Size() - 1].id == 1 && Obj::num_copied == 1);
+        assert(v.BytesAllocated() > v.Capacity() * sizeof(Obj));
+
+        // Копирование и перемещение вектора посреди переноса
+        const IncrementalVector<Obj> copy(v);
+        assert(copy.Size() == v.Size() && !copy.IsMigrating() && copy[500].id == 500);
+        IncrementalVector<Obj> moved(std::move(v));
+        assert(v.Size() == 0 && moved.IsMigrating() && moved[999].id == 999);
+        v = std::move(moved);
+
+        // Удаление элементов старого блока посреди переноса
+        const size_t old_count = v.Size() - 1;
+        while (v.Size() > old_count / 2) {
+            v.PopBack();
+        }
+        assert(v[v.Size() - 1].id == static_cast<int>(old_count / 2 - 1) && v.IsMigrating());
+        while (v.IsMigrating()) {
+            v.EmplaceBack(-1);
+        }
+        assert(v[0].id == 0 && v[old_count / 2 - 1].id == static_cast<int>(old_count / 2 - 1));
+
+        // Исключение в конструкторе элемента при росте оставляет вектор целым
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(2);
+        }
+        const size_t size = v.Size();
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == size && v[size - 1].id == 2 && v[0].id == 0);
+        assert(static_cast<size_t>(Obj::GetAliveObjectCount()) == v.Size() + copy.Size());
+        assert(v.Migrate(10) == size - 10 && v.Migrate() == 0 && !v.IsMigrating());
+
+        v.Reserve(v.Capacity() * 4);
+        assert(v.Size() == size && v[size - 1].id == 2);
+        v.Clear(true);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        RelocatableObj::num_moved = 0;
+        IncrementalVector<RelocatableObj> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        // Тривиально перемещаемые элементы переносятся побайтово
+        assert(RelocatableObj::num_moved == 0 && *v[99].id == 99);
+    }
+    {
+        IncrementalVector<int> v;
+        for (int i = 0; i < 100000; ++i) {
+            v.PushBack(100000 - i);
+        }
+        std::sort(v.begin(), v.end());
+        assert(std::is_sorted(v.cbegin(), v.cend()) && v[0] == 1 && v[99999] == 100000);
+    }
+}
+
+void Test31() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> values;
+        for (int i = 0; i < 10; ++i) {
+            values.EmplaceBack(i);
+        }
+        const CowVector<Obj> snapshot(std::move(values));
+        assert(snapshot.Size() == 10 && snapshot.UseCount() == 1 && Obj::num_copied == 0);
+
+        // Копии разделяют блок и не копируют элементы
+        CowVector<Obj> copy = snapshot;
+        const CowVector<Obj> other = copy;
+        assert(copy.SharesWith(snapshot) && snapshot.UseCount() == 3 && Obj::num_copied == 0);
+        assert(copy.Data() == snapshot.Data() && copy[9].id == 9);
+
+        // Первое изменение отсоединяет блок; аргумент ссылается на элемент разделённого блока
+        copy.PushBack(copy[3]);
+        assert(!copy.SharesWith(snapshot) && copy.UseCount() == 1 && snapshot.UseCount() == 2);
+        assert(copy.Size() == 11 && copy[10].id == 3 && snapshot.Size() == 10);
+        assert(Obj::num_copied == 11);
+
+        // Единственный владелец меняет элементы на месте
+        copy.Mutable()[0].id = 100;
+        assert(Obj::num_copied == 11 && copy[0].id == 100 && snapshot[0].id == 0 && other[0].id == 0);
+
+        copy = snapshot;
+        assert(copy.UseCount() == 3 && copy[0].id == 0);
+        copy.Clear();
+        assert(copy.Size() == 0 && copy.UseCount() == 0 && snapshot.UseCount() == 2);
+        copy.EmplaceBack(7);
+        assert(copy.Size() == 1 && copy[0].id == 7);
+        assert(Obj::GetAliveObjectCount() == 11);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Читатели копируют опубликованный снимок, пока писатель меняет свою копию
+        const CowVector<int> snapshot{1, 2, 3, 4, 5};
+        std::atomic<long long> total{0};
+        Vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.EmplaceBack([&snapshot, &total] {
+                long long sum = 0;
+                for (int i = 0; i < 10000; ++i) {
+                    const CowVector<int> local = snapshot;
+                    sum += std::accumulate(local.begin(), local.end(), 0);
+                }
+                total += sum;
+            });
+        }
+        CowVector<int> writer = snapshot;
+        for (int i = 0; i < 1000; ++i) {
+            writer.PushBack(i);
+        }
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(total == 4 * 10000 * 15 && snapshot.UseCount() == 1 && writer.Size() == 1005);
+    }
+}
+
+void Test32() {
+    const size_t num_nodes = NumaNodeCount();
+    assert(num_nodes >= 1);
+    const NumaNodeMask allowed = NumaAllowedNodes();
+    unsigned first_node = 0;
+    while (!allowed.Test(first_node)) {
+        ++first_node;
+    }
+    const size_t SIZE = size_t(1) << 20;
+    const ParallelPolicy policy{4, size_t(1) << 16};
+    for (const NumaPlacement& placement : {NumaPlacement{NumaPolicy::FIRST_TOUCH}, NumaPlacement{NumaPolicy::INTERLEAVE},
+                                           NumaPlacement{NumaPolicy::BIND, first_node},
+                                           NumaPlacement{NumaPolicy::PARTITIONED, 0, 4}}) {
+        // Элементы создаются частями в разных потоках после назначения политики
+        Vector<int, NumaAllocator<int>> v(SIZE, policy, NumaAllocator<int>(placement));
+        assert(v.Size() == SIZE && v[0] == 0 && v[SIZE - 1] == 0);
+#if defined(__linux__)
+        for (size_t i = 0; i < SIZE; i += SIZE / 8) {
+            const int node = NumaNodeOf(&v[i]);
+            assert(node >= 0 && allowed.Test(static_cast<size_t>(node)));
+        }
+#endif
+        const Vector<int, NumaAllocator<int>> copy(v);
+        assert(copy.GetAllocator().Placement().policy == placement.policy && copy[SIZE / 2] == 0);
+    }
+    {
+        // Малые блоки выделяются из кучи
+        Vector<int, NumaAllocator<int>> v(NumaAllocator<int>({NumaPolicy::INTERLEAVE}));
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == 100 && v[99] == 99);
+    }
+#if defined(__linux__)
+    // Узел вне доступных отвергается ядром
+    size_t missing = 0;
+    while (allowed.Test(missing)) {
+        ++missing;
+    }
+    try {
+        Vector<int, NumaAllocator<int>> v(SIZE, NumaAllocator<int>({NumaPolicy::BIND, static_cast<unsigned>(missing)}));
+        assert(false);
+    } catch (const std::system_error&) {
+    }
+#endif
+}
+
+void Test33() {
+    {
+        // Пакет с повторами сортируется при создании
+        FlatSet<int> set{5, 3, 9, 3, 1, 5};
+        assert(set.Size() == 4 && std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains(9) && !set.Contains(4) && set.Count(3) == 1);
+        assert(*set.LowerBound(4) == 5 && *set.UpperBound(5) == 9 && set.LowerBound(10) == set.end());
+
+        assert(set.Insert(4).second && !set.Insert(4).second && set.Size() == 5);
+        // Пакетная вставка сливается с прежними элементами
+        const int batch[] = {8, 2, 10, 4, 0};
+        set.Insert(std::begin(batch), std::end(batch));
+        assert(set.Size() == 9 && std::is_sorted(set.begin(), set.end()) && *set.begin() == 0);
+
+        const int keys[] = {10, 0, 7, 4};
+        assert(set.EraseKeys(std::begin(keys), std::end(keys)) == 3);
+        assert(set.Erase(5) == 1 && set.Erase(5) == 0);
+        assert(set.EraseIf([](int key) {
+            return key % 2 == 0;
+        }) == 2);
+        const int remaining[] = {1, 3, 9};
+        assert(std::equal(set.begin(), set.end(), std::begin(remaining), std::end(remaining)));
+
+        FlatSet<int, std::greater<int>> descending(Vector<int>{1, 4, 2, 4});
+        assert(descending.Size() == 3 && descending.Values()[0] == 4 && *descending.LowerBound(3) == 2);
+    }
+    {
+        FlatMap<std::string, int> map{{"b", 2}, {"a", 1}, {"b", 20}};
+        // Из равных ключей остаётся первый, как у std::map
+        assert(map.Size() == 2 && map.At("b") == 2 && map.begin()->first == "a");
+        map["c"] += 3;
+        assert(map.Size() == 3 && map.At("c") == 3);
+        assert(!map.TryEmplace("a", 100).second && map.At("a") == 1);
+        assert(!map.InsertOrAssign("a", 100).second && map.At("a") == 100);
+        map.Find("b")->second = 7;
+        const FlatMap<std::string, int>& const_map = map;
+        assert(const_map.At("b") == 7 && const_map.Find("z") == const_map.end());
+        try {
+            map.At("z");
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        map.Insert({{"e", 5}, {"d", 4}, {"a", -1}});
+        assert(map.Size() == 5 && map.At("a") == 100 && (map.end() - 1)->first == "e");
+        map.Erase(map.Find("c"));
+        assert(map.Size() == 4 && !map.Contains("c"));
+        // Через неконстантный итератор ключ только читается, а значение меняется
+        static_assert(std::is_same_v<decltype(map.begin()->first), const std::string&>);
+        static_assert(!std::is_assignable_v<decltype((*map.begin()).first), std::string>);
+        for (auto [key, value] : map) {
+            value += static_cast<int>(key.size());
+        }
+        assert(map.At("a") == 101 && map.At("e") == 6 && map.Find("z") == map.end());
+        FlatMap<std::string, int>::const_iterator first = map.begin();
+        assert(first == map.Values().begin() && map.end() - map.begin() == 4);
+        Vector<std::pair<std::string, int>> values = map.Extract();
+        assert(map.Size() == 0 && values.Size() == 4 && values[0].first == "a");
+    }
+    {
+        // Сверка со std::set и std::map на случайных пакетах
+        std::mt19937 rng(33);
+        FlatSet<int> set;
+        FlatMap<int, int> map;
+        std::set<int> expected_set;
+        std::map<int, int> expected_map;
+        for (int round = 0; round < 200; ++round) {
+            Vector<int> batch;
+            Vector<std::pair<int, int>> pairs;
+            const size_t count = rng() % 20;
+            for (size_t i = 0; i < count; ++i) {
+                const int key = static_cast<int>(rng() % 500);
+                batch.PushBack(key);
+                pairs.PushBack(std::pair{key, round});
+                expected_set.insert(key);
+                expected_map.insert({key, round});
+            }
+            set.Insert(batch.begin(), batch.end());
+            map.Insert(pairs.begin(), pairs.end());
+            const int erased = static_cast<int>(rng() % 500);
+            assert(set.Erase(erased) == expected_set.erase(erased));
+            assert(map.Erase(erased) == expected_map.erase(erased));
+            const int bumped = static_cast<int>(rng() % 500);
+            map[bumped] += 1;
+            expected_map[bumped] += 1;
+        }
+        assert(std::equal(set.begin(), set.end(), expected_set.begin(), expected_set.end()));
+        assert(std::equal(map.begin(), map.end(), expected_map.begin(), expected_map.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first == rhs.first && lhs.second == rhs.second;
+        }));
+        for (int key = -1; key <= 500; ++key) {
+            assert(set.Contains(key) == (expected_set.count(key) == 1));
+            const auto it = expected_set.lower_bound(key);
+            assert(set.LowerBound(key) == set.end() ? it == expected_set.end() : *set.LowerBound(key) == *it);
+        }
+    }
+}
+
+// Число случайных последовательностей операций в Test34 на каждый тип элемента
+#if !defined(VECTOR_FUZZ_SEEDS)
+#define VECTOR_FUZZ_SEEDS 30
+#endif
+
+// Obj с перемещением без noexcept: Vector переносит такие элементы копированием. Копирование
+// и присваивание отсчитывают Obj::default_construction_throw_countdown, поэтому исключение
+// может прервать перераспределение памяти на середине
+struct ThrowingCopyObj {
+    ThrowingCopyObj() = default;
+
+    explicit ThrowingCopyObj(int id)
+        : obj(id) {
+    }
+
+    ThrowingCopyObj(const ThrowingCopyObj& other)
+        : obj(other.obj) {
+        CountDown();
+    }
+
+    ThrowingCopyObj(ThrowingCopyObj&& other)
+        : obj(std::move(other.obj)) {
+    }
+
+    ThrowingCopyObj& operator=(const ThrowingCopyObj& other) {
+        CountDown();
+        obj = other.obj;
+        return *this;
+    }
+
+    ThrowingCopyObj& operator=(ThrowingCopyObj&& other) {
+        obj = std::move(other.obj);
+        return *this;
+    }
+
+    static void CountDown() {
+        if (Obj::default_construction_throw_countdown > 0 && --Obj::default_construction_throw_countdown == 0) {
+            throw std::runtime_error("Oops");
+        }
+    }
+
+    Obj obj;
+};
+
+int FuzzId(int value) {
+    return value;
+}
+
+int FuzzId(const Obj& value) {
+    return value.id;
+}
+
+int FuzzId(const ThrowingCopyObj& value) {
+    return value.obj.id;
+}
+
+template <typename T>
+T FuzzMake(int id) {
+    if constexpr (std::is_same_v<T, int>) {
+        return id;
+    } else {
+        return T(id);
+    }
+}
+
+template <typename T>
+void FuzzCheckEqual(const Vector<T>& v, const std::vector<T>& expected) {
+    assert(v.Size() == expected.size() && v.Size() <= v.Capacity());
+    for (size_t i = 0; i < v.Size(); ++i) {
+        assert(FuzzId(v[i]) == FuzzId(expected[i]));
+    }
+}
+
+// Применяет одну и ту же случайную последовательность операций к Vector<T> и std::vector<T>
+// и сверяет их после каждой. Перед частью операций Vector заводится обратный отсчёт исключения.
+// Если операция со строгой гарантией выбросила исключение, Vector должен остаться прежним;
+// после остальных он лишь должен остаться корректным, и эталон заменяется его содержимым.
+// Утечки и повторные уничтожения выдаёт счётчик живых Obj, а под ASan — сам санитайзер
+template <typename T>
+void FuzzAgainstStdVector(unsigned seed) {
+    constexpr bool COUNTS_OBJECTS = !std::is_same_v<T, int>;
+    Obj::ResetCounters();
+    {
+        std::mt19937 rng(seed);
+        const auto random = [&rng](size_t bound) {
+            return bound == 0 ? size_t(0) : static_cast<size_t>(rng() % bound);
+        };
+        Vector<T> vectors[2];
+        std::vector<T> models[2];
+        int next_id = 1;
+        for (int step = 0; step < 300; ++step) {
+            const size_t a = random(2);
+            const size_t b = random(2);
+            Vector<T>& v = vectors[a];
+            std::vector<T>& model = models[a];
+            const size_t size = v.Size();
+            const size_t pos = random(size + 1);
+            const size_t elem = random(size);
+            const size_t count = random(6);
+            const size_t new_size = random(size + 10);
+            const int id = next_id++;
+            const int op = static_cast<int>(random(18));
+            // Операции над существующим элементом на пустом векторе пропускаются
+            if (size == 0 && (op == 1 || op == 5 || (op >= 7 && op <= 9) || op == 10)) {
+                continue;
+            }
+            const size_t erase_last = elem + random(size - elem + 1);
+            // Операции со строгой гарантией: при исключении Vector не меняется
+            const bool strong = op <= 2 || (op >= 11 && op <= 13) || op == 17;
+            const auto apply_vector = [&] {
+                switch (op) {
+                case 0: v.PushBack(FuzzMake<T>(id)); break;
+                // Аргумент ссылается на элемент самого вектора, в том числе при росте
+                case 1: v.PushBack(v[elem]); break;
+                case 2: v.EmplaceBack(id); break;
+                case 3: v.Emplace(v.begin() + pos, id); break;
+                case 4: v.Insert(v.begin() + pos, FuzzMake<T>(id)); break;
+                case 5: v.Insert(v.begin() + pos, v[elem]); break;
+                case 6: {
+                    const T value = FuzzMake<T>(id);
+                    v.Insert(v.begin() + pos, count, value);
+                    break;
+                }
+                case 7: v.Erase(v.begin() + elem); break;
+                case 8: v.Erase(v.begin() + elem, v.begin() + erase_last); break;
+                case 9: v.SwapErase(v.begin() + elem); break;
+                case 10: v.Insert(v.begin() + pos, count, v[elem]); break;
+                case 11: v.Resize(new_size); break;
+                case 12: v.Reserve(v.Capacity() + count); break;
+                case 13: v.ShrinkToFit(); break;
+                case 14: v = vectors[b]; break;
+                case 15: {
+                    std::vector<T> source;
+                    for (size_t i = 0; i < count; ++i) {
+                        source.push_back(FuzzMake<T>(id));
+                    }
+                    v.Insert(v.begin() + pos, source.begin(), source.end());
+                    break;
+                }
+                case 16: if (size > 0) v.PopBack(); break;
+                case 17: FuzzCheckEqual(Vector<T>(v), model); break;
+                }
+            };
+            const auto apply_model = [&] {
+                switch (op) {
+                case 0: model.push_back(FuzzMake<T>(id)); break;
+                case 1: model.push_back(model[elem]); break;
+                case 2: model.emplace_back(id); break;
+                case 3: model.emplace(model.begin() + pos, id); break;
+                case 4: model.insert(model.begin() + pos, FuzzMake<T>(id)); break;
+                case 5: model.insert(model.begin() + pos, model[elem]); break;
+                case 6: model.insert(model.begin() + pos, count, FuzzMake<T>(id)); break;
+                case 7: model.erase(model.begin() + elem); break;
+                case 8: model.erase(model.begin() + elem, model.begin() + erase_last); break;
+                case 9:
+                    if (elem + 1 != model.size()) {
+                        model[elem] = std::move(model.back());
+                    }
+                    model.pop_back();
+                    break;
+                case 10: model.insert(model.begin() + pos, count, model[elem]); break;
+                case 11: model.resize(new_size); break;
+                case 14: model = models[b]; break;
+                case 15: model.insert(model.begin() + pos, count, FuzzMake<T>(id)); break;
+                case 16: if (size > 0) model.pop_back(); break;
+                }
+            };
+            const auto check_alive = [&vectors, &models] {
+                if constexpr (COUNTS_OBJECTS) {
+                    const size_t alive = vectors[0].Size() + vectors[1].Size() + models[0].size() + models[1].size();
+                    assert(static_cast<size_t>(Obj::GetAliveObjectCount()) == alive);
+                }
+            };
+            const bool inject = COUNTS_OBJECTS && random(4) == 0;
+            if (inject) {
+                Obj::default_construction_throw_countdown = static_cast<int>(1 + random(8));
+            }
+            try {
+                apply_vector();
+            } catch (const std::runtime_error&) {
+                assert(inject && Obj::default_construction_throw_countdown == 0);
+                if (strong) {
+                    FuzzCheckEqual(v, model);
+                } else {
+                    model.clear();
+                    for (const T& value : v) {
+                        model.push_back(value);
+                    }
+                }
+                check_alive();
+                continue;
+            }
+            Obj::default_construction_throw_countdown = 0;
+            apply_model();
+            FuzzCheckEqual(vectors[0], models[0]);
+            FuzzCheckEqual(vectors[1], models[1]);
+            check_alive();
+            // Изредка проверяем перемещающее присваивание и обмен
+            if (random(16) == 0 && a != b) {
+                vectors[a] = std::move(vectors[b]);
+                models[a] = std::move(models[b]);
+                vectors[b].Clear();
+                models[b].clear();
+            } else if (random(16) == 0) {
+                vectors[a].Swap(vectors[b]);
+                models[a].swap(models[b]);
+            }
+        }
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test34() {
+    for (unsigned seed = 0; seed < VECTOR_FUZZ_SEEDS; ++seed) {
+        FuzzAgainstStdVector<int>(seed);
+        FuzzAgainstStdVector<Obj>(seed);
+        FuzzAgainstStdVector<ThrowingCopyObj>(seed);
     }
 }
 
@@ -647,7 +2634,36 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+#if defined(__unix__) || defined(__APPLE__)
+        Test24();
+#endif
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Аллокатор на malloc/free, умеющий расширять блок на месте через realloc.
+// Блоки от MmapThreshold байт и больше выделяются напрямую страницами через mmap
+// и растут через mremap, без промежуточной копии и без двойного расхода памяти.
+// Вместе с тривиально перемещаемыми T позволяет Vector расти без аллокации нового блока
+template <typename T, size_t MmapThreshold = (size_t(1) << 25)>
+class MallocAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = MallocAllocator<U, MmapThreshold>;
+    };
+
+    MallocAllocator() noexcept = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U, MmapThreshold>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = n * sizeof(T);
+        void* ptr = IsMapped(bytes) ? Map(bytes) : std::malloc(bytes);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsMapped(bytes)) {
+            Unmap(ptr, bytes);
+        } else {
+            std::free(ptr);
+        }
+    }
+
+    // Изменяет размер блока с old_n до new_n элементов, сохраняя его содержимое побайтово.
+    // Блок может остаться на месте или переехать; при ошибке исходный блок не изменяется
+    T* reallocate(T* ptr, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = new_n * sizeof(T);
+        void* new_ptr = nullptr;
+        if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+            new_ptr = Remap(ptr, old_bytes, new_bytes);
+        } else if (!IsMapped(old_bytes) && !IsMapped(new_bytes)) {
+            new_ptr = std::realloc(static_cast<void*>(ptr), new_bytes);
+        } else {
+            // Блок переходит через порог: копируем между malloc и mmap
+            new_ptr = IsMapped(new_bytes) ? Map(new_bytes) : std::malloc(new_bytes);
+            if (new_ptr != nullptr) {
+                std::memcpy(new_ptr, static_cast<const void*>(ptr), std::min(old_bytes, new_bytes));
+                deallocate(ptr, old_n);
+            }
+        }
+        if (new_ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_ptr);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U, MmapThreshold>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U, MmapThreshold>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+#if defined(__linux__)
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= MmapThreshold;
+    }
+
+    static size_t PageRound(size_t bytes) noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page_size - 1) / page_size * page_size;
+    }
+
+    static void* Map(size_t bytes) noexcept {
+        void* ptr = mmap(nullptr, PageRound(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return ptr != MAP_FAILED ? ptr : nullptr;
+    }
+
+    static void* Remap(void* ptr, size_t old_bytes, size_t new_bytes) noexcept {
+        void* new_ptr = mremap(ptr, PageRound(old_bytes), PageRound(new_bytes), MREMAP_MAYMOVE);
+        return new_ptr != MAP_FAILED ? new_ptr : nullptr;
+    }
+
+    static void Unmap(void* ptr, size_t bytes) noexcept {
+        munmap(ptr, PageRound(bytes));
+    }
+#else
+    // Без mmap все блоки обслуживаются malloc/realloc
+    static bool IsMapped(size_t /*bytes*/) noexcept {
+        return false;
+    }
+
+    static void* Map(size_t /*bytes*/) noexcept {
+        return nullptr;
+    }
+
+    static void* Remap(void* /*ptr*/, size_t /*old_bytes*/, size_t /*new_bytes*/) noexcept {
+        return nullptr;
+    }
+
+    static void Unmap(void* /*ptr*/, size_t /*bytes*/) noexcept {
+    }
+#endif
+};
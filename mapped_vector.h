@@ -0,0 +1,314 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Способ отображения файла в MappedVector
+enum class MapMode {
+    // Только чтение; страницы общие с кэшем ФС и другими процессами
+    READ_ONLY,
+    // Изменения видны только этому процессу и не попадают в файл.
+    // При росте элементы копируются в анонимную память
+    COPY_ON_WRITE,
+    // Изменения и рост записываются в файл; файл создаётся, если его нет
+    READ_WRITE,
+};
+
+// Подсказки ядру о порядке доступа к страницам, см. madvise
+enum class MapAdvice {
+    NORMAL = MADV_NORMAL,
+    SEQUENTIAL = MADV_SEQUENTIAL,
+    RANDOM = MADV_RANDOM,
+    WILL_NEED = MADV_WILLNEED,
+    // Не подсказка: страницы сразу отбрасываются. В общем отображении файла (READ_ONLY и
+    // READ_WRITE) они перечитаются из файла при следующем обращении, а в приватном или
+    // анонимном отображении изменения пропали бы, поэтому в режиме COPY_ON_WRITE Advise
+    // отвергает DONT_NEED. Затрагиваются целые страницы, а не только элементы диапазона
+    DONT_NEED = MADV_DONTNEED,
+};
+
+// Вектор тривиально копируемых элементов, хранящихся прямо в отображённом в память файле.
+// Файл — это массив элементов без заголовка. Открытие не читает файл, страницы подгружаются
+// при первом обращении. В режиме READ_WRITE файл растёт через ftruncate, отображение —
+// через mremap, а при закрытии файл обрезается до размера вектора.
+// Ошибки системных вызовов выбрасываются как std::system_error
+template <typename T, typename Growth = PageRoundedGrowth<>>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector requires a trivially copyable type");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    MappedVector() = default;
+
+    MappedVector(const std::string& path, MapMode mode)
+        : mode_(mode)
+    {
+        const int flags = mode == MapMode::READ_WRITE ? O_RDWR | O_CREAT : O_RDONLY;
+        fd_ = open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open");
+        }
+        try {
+            struct stat st;
+            if (fstat(fd_, &st) != 0) {
+                ThrowSystemError("fstat");
+            }
+            const size_t bytes = static_cast<size_t>(st.st_size);
+            if (bytes % sizeof(T) != 0) {
+                throw std::system_error(EINVAL, std::generic_category(), "file size is not a multiple of sizeof(T)");
+            }
+            size_ = capacity_ = bytes / sizeof(T);
+            if (bytes != 0) {
+                data_ = static_cast<T*>(Map(bytes, Protection(), mode == MapMode::COPY_ON_WRITE ? MAP_PRIVATE : MAP_SHARED, fd_));
+            }
+        } catch (...) {
+            close(fd_);
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept {
+        Swap(other);
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            MappedVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        if (data_ != nullptr) {
+            munmap(data_, capacity_ * sizeof(T));
+        }
+        if (fd_ >= 0) {
+            if (mode_ == MapMode::READ_WRITE && size_ != capacity_) {
+                // Запас вместимости в файл не попадает
+                [[maybe_unused]] const int result = ftruncate(fd_, static_cast<off_t>(size_ * sizeof(T)));
+            }
+            close(fd_);
+        }
+    }
+
+    void Swap(MappedVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(mode_, other.mode_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    MapMode Mode() const noexcept {
+        return mode_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    T* Data() noexcept {
+        return data_;
+    }
+
+    const T* Data() const noexcept {
+        return data_;
+    }
+
+    // В режиме READ_ONLY страницы защищены от записи: элементы можно только читать
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    iterator begin() noexcept {
+        return data_;
+    }
+
+    iterator end() noexcept {
+        return data_ + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return data_;
+    }
+
+    const_iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    void Reserve(size_t new_capacity) {
+        assert(mode_ != MapMode::READ_ONLY);
+        if (new_capacity > capacity_) {
+            Remap(new_capacity);
+        }
+    }
+
+    // Новые элементы инициализируются нулями
+    void Resize(size_t new_size) {
+        assert(mode_ != MapMode::READ_ONLY);
+        if (new_size > capacity_) {
+            Remap(Growth::NextCapacity(capacity_, new_size, sizeof(T)));
+        }
+        if (new_size > size_) {
+            std::memset(static_cast<void*>(data_ + size_), 0, (new_size - size_) * sizeof(T));
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const T& value) {
+        assert(mode_ != MapMode::READ_ONLY);
+        if (size_ == capacity_) {
+            // value может лежать в отображении, которое переедет
+            const T copy = value;
+            Remap(Growth::NextCapacity(capacity_, size_ + 1, sizeof(T)));
+            data_[size_++] = copy;
+        } else {
+            data_[size_++] = value;
+        }
+    }
+
+    void PopBack() noexcept {
+        assert(mode_ != MapMode::READ_ONLY && size_ > 0);
+        --size_;
+    }
+
+    // Добавляет элементы диапазона [first, first + count) одним копированием
+    void Append(const T* first, size_t count) {
+        assert(mode_ != MapMode::READ_ONLY);
+        if (size_ + count > capacity_) {
+            // Диапазон не должен ссылаться на элементы самого вектора
+            Remap(Growth::NextCapacity(capacity_, size_ + count, sizeof(T)));
+        }
+        if (count != 0) {
+            std::memcpy(static_cast<void*>(data_ + size_), static_cast<const void*>(first), count * sizeof(T));
+        }
+        size_ += count;
+    }
+
+    // Записывает изменённые страницы в файл. Имеет смысл только в режиме READ_WRITE
+    void Flush(bool async = false) {
+        if (mode_ == MapMode::READ_WRITE && data_ != nullptr
+            && msync(data_, capacity_ * sizeof(T), async ? MS_ASYNC : MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    // Подсказывает ядру, как будут читаться элементы [first, first + count)
+    void Advise(MapAdvice advice, size_t first = 0, size_t count = size_t(-1)) {
+        if (advice == MapAdvice::DONT_NEED && mode_ == MapMode::COPY_ON_WRITE) {
+            throw std::system_error(EINVAL, std::generic_category(), "MADV_DONTNEED would discard private changes");
+        }
+        if (data_ == nullptr || first >= size_) {
+            return;
+        }
+        count = std::min(count, size_ - first);
+        // madvise требует адрес, выровненный по странице
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const auto address = reinterpret_cast<std::uintptr_t>(data_ + first);
+        const std::uintptr_t page_address = address / page_size * page_size;
+        if (madvise(reinterpret_cast<void*>(page_address), address - page_address + count * sizeof(T),
+                    static_cast<int>(advice)) != 0) {
+            ThrowSystemError("madvise");
+        }
+    }
+
+private:
+    int fd_ = -1;
+    MapMode mode_ = MapMode::READ_ONLY;
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    [[noreturn]] static void ThrowSystemError(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    int Protection() const noexcept {
+        return mode_ == MapMode::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    }
+
+    static void* Map(size_t bytes, int protection, int flags, int fd) {
+        void* ptr = mmap(nullptr, bytes, protection, flags, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        return ptr;
+    }
+
+    // Отображает файл, уже увеличенный до new_bytes, вместо текущего отображения
+    void* RemapFile(size_t old_bytes, size_t new_bytes) {
+        if (data_ == nullptr) {
+            return Map(new_bytes, Protection(), MAP_SHARED, fd_);
+        }
+#if defined(__linux__)
+        void* new_data = mremap(data_, old_bytes, new_bytes, MREMAP_MAYMOVE);
+        if (new_data == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+#else
+        // Без mremap файл отображается заново: данные уже в файле, копировать нечего
+        void* new_data = Map(new_bytes, Protection(), MAP_SHARED, fd_);
+        munmap(data_, old_bytes);
+#endif
+        return new_data;
+    }
+
+    void Remap(size_t new_capacity) {
+        const size_t old_bytes = capacity_ * sizeof(T);
+        const size_t new_bytes = new_capacity * sizeof(T);
+        void* new_data = nullptr;
+        if (mode_ == MapMode::READ_WRITE) {
+            if (ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+                ThrowSystemError("ftruncate");
+            }
+            try {
+                new_data = RemapFile(old_bytes, new_bytes);
+            } catch (...) {
+                // Иначе нули в хвосте файла при следующем открытии станут элементами:
+                // деструктор обрезает файл, только если вместимость больше размера
+                [[maybe_unused]] const int result = ftruncate(fd_, static_cast<off_t>(old_bytes));
+                throw;
+            }
+        } else {
+            // Приватные изменения за пределами файла хранить негде, кроме анонимной памяти
+            new_data = Map(new_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1);
+            if (data_ != nullptr) {
+                std::memcpy(new_data, static_cast<const void*>(data_), size_ * sizeof(T));
+                munmap(data_, old_bytes);
+            }
+        }
+        data_ = static_cast<T*>(new_data);
+        capacity_ = new_capacity;
+    }
+};
+
+#endif
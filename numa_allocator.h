@@ -0,0 +1,274 @@
+#pragma once
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <new>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Размещение страниц блока по узлам NUMA
+enum class NumaPolicy {
+    // Страница попадает на узел потока, первым записавшего в неё. Вместе с параллельным
+    // созданием элементов (Vector(size, PARALLEL, alloc)) части блока оказываются
+    // на узлах создававших их потоков
+    FIRST_TOUCH,
+    // Страницы по очереди распределяются по всем доступным узлам
+    INTERLEAVE,
+    // Все страницы на узле node
+    BIND,
+    // Блок делится на parts частей так же, как ParallelChunkBegin делит элементы, и часть k
+    // предпочтительно размещается на узле с номером k * (число узлов) / parts среди доступных.
+    // Подходит, когда обработку выполняют потоки, закреплённые по узлам в том же порядке
+    PARTITIONED,
+};
+
+struct NumaPlacement {
+    NumaPolicy policy = NumaPolicy::FIRST_TOUCH;
+    // Узел для BIND
+    unsigned node = 0;
+    // Число частей для PARTITIONED; должно совпадать с числом частей обработки
+    size_t parts = 1;
+};
+
+// Наибольшее число узлов, которое учитывают функции NUMA
+inline constexpr size_t MAX_NUMA_NODES = 1024;
+
+// Маска узлов в формате системных вызовов mbind и get_mempolicy
+struct NumaNodeMask {
+    static constexpr size_t BITS_PER_WORD = sizeof(unsigned long) * 8;
+
+    unsigned long words[MAX_NUMA_NODES / BITS_PER_WORD] = {};
+
+    void Set(size_t node) noexcept {
+        words[node / BITS_PER_WORD] |= 1UL << (node % BITS_PER_WORD);
+    }
+
+    bool Test(size_t node) const noexcept {
+        return (words[node / BITS_PER_WORD] >> (node % BITS_PER_WORD)) & 1;
+    }
+};
+
+#if defined(__linux__)
+// Константы из linux/mempolicy.h; libnuma не требуется
+inline constexpr int NUMA_MPOL_PREFERRED = 1;
+inline constexpr int NUMA_MPOL_BIND = 2;
+inline constexpr int NUMA_MPOL_INTERLEAVE = 3;
+inline constexpr unsigned long NUMA_MPOL_F_NODE = 1;
+inline constexpr unsigned long NUMA_MPOL_F_ADDR = 2;
+inline constexpr unsigned long NUMA_MPOL_F_MEMS_ALLOWED = 4;
+
+// Узлы, на которых процессу разрешено выделять память. Без поддержки NUMA в ядре — только узел 0
+inline NumaNodeMask NumaAllowedNodes() noexcept {
+    NumaNodeMask mask;
+    // Ядро учитывает на один бит меньше переданного maxnode
+    if (syscall(SYS_get_mempolicy, nullptr, mask.words, MAX_NUMA_NODES + 1, nullptr, NUMA_MPOL_F_MEMS_ALLOWED) != 0) {
+        mask = NumaNodeMask();
+        mask.Set(0);
+    }
+    return mask;
+}
+
+// Узел, на котором находится страница с адресом address, или -1, если страница ещё
+// не выделена или узел неизвестен
+inline int NumaNodeOf(const void* address) noexcept {
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0UL, address, NUMA_MPOL_F_NODE | NUMA_MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+// Назначает страницам [address, address + bytes) политику mode с маской nodes.
+// address выровнен по странице. Без поддержки NUMA в ядре ничего не делает
+inline void NumaBind(void* address, size_t bytes, int mode, const NumaNodeMask& nodes) {
+    if (syscall(SYS_mbind, address, bytes, mode, nodes.words, MAX_NUMA_NODES + 1, 0U) != 0 && errno != ENOSYS) {
+        throw std::system_error(errno, std::generic_category(), "mbind");
+    }
+}
+#else
+// Без NUMA доступен один узел
+inline NumaNodeMask NumaAllowedNodes() noexcept {
+    NumaNodeMask mask;
+    mask.Set(0);
+    return mask;
+}
+
+inline int NumaNodeOf(const void* /*address*/) noexcept {
+    return -1;
+}
+#endif
+
+// Число узлов, на которых процессу разрешено выделять память
+inline size_t NumaNodeCount() noexcept {
+    const NumaNodeMask mask = NumaAllowedNodes();
+    size_t count = 0;
+    for (size_t node = 0; node < MAX_NUMA_NODES; ++node) {
+        count += mask.Test(node);
+    }
+    return count;
+}
+
+// Аллокатор, размещающий большие блоки (от NUMA_MIN_BYTES байт) по узлам NUMA согласно NumaPlacement.
+// Такие блоки выделяются через mmap, поэтому их страницы ещё не тронуты и размещаются политикой,
+// а не тем, где раньше использовалась память кучи. Малые блоки выделяются через operator new.
+// Блок любого экземпляра освобождается любым другим, поэтому все экземпляры равны.
+// Если ядро отвергает политику, например узел BIND не существует, выбрасывается std::system_error.
+// На системах без mmap размещение не выполняется
+template <typename T>
+class NumaAllocator {
+public:
+    static constexpr size_t NUMA_MIN_BYTES = size_t(64) << 10;
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = NumaAllocator<U>;
+    };
+
+    NumaAllocator() noexcept = default;
+
+    explicit NumaAllocator(const NumaPlacement& placement) noexcept
+        : placement_(placement)
+    {
+    }
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U>& other) noexcept
+        : placement_(other.Placement())
+    {
+    }
+
+    const NumaPlacement& Placement() const noexcept {
+        return placement_;
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = n * sizeof(T);
+        if (IsMapped(bytes)) {
+            return static_cast<T*>(MapPlaced(n));
+        }
+        return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsMapped(bytes)) {
+            Unmap(ptr, bytes);
+        } else {
+            ::operator delete(ptr, bytes, std::align_val_t(alignof(T)));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const NumaAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const NumaAllocator<U>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    NumaPlacement placement_;
+
+#if defined(__linux__)
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= NUMA_MIN_BYTES;
+    }
+
+    static size_t PageSize() noexcept {
+        static const size_t PAGE_SIZE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return PAGE_SIZE;
+    }
+
+    static size_t PageRound(size_t bytes) noexcept {
+        return (bytes + PageSize() - 1) / PageSize() * PageSize();
+    }
+
+    void* MapPlaced(size_t n) const {
+        const size_t size = PageRound(n * sizeof(T));
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        try {
+            Place(static_cast<char*>(ptr), size, n);
+        } catch (...) {
+            munmap(ptr, size);
+            throw;
+        }
+        return ptr;
+    }
+
+    // Политика назначается до первой записи в страницы
+    void Place(char* ptr, size_t size, size_t n) const {
+        NumaNodeMask nodes;
+        switch (placement_.policy) {
+        case NumaPolicy::FIRST_TOUCH:
+            return;
+        case NumaPolicy::INTERLEAVE:
+            NumaBind(ptr, size, NUMA_MPOL_INTERLEAVE, NumaAllowedNodes());
+            return;
+        case NumaPolicy::BIND:
+            if (placement_.node >= MAX_NUMA_NODES) {
+                throw std::system_error(EINVAL, std::generic_category(), "NUMA node out of range");
+            }
+            nodes.Set(placement_.node);
+            NumaBind(ptr, size, NUMA_MPOL_BIND, nodes);
+            return;
+        case NumaPolicy::PARTITIONED:
+            PlacePartitioned(ptr, size, n);
+            return;
+        }
+    }
+
+    // Граница части округляется вниз до страницы: страница на стыке достаётся следующей части
+    void PlacePartitioned(char* ptr, size_t size, size_t n) const {
+        const NumaNodeMask allowed = NumaAllowedNodes();
+        unsigned short node_ids[MAX_NUMA_NODES];
+        size_t num_nodes = 0;
+        for (size_t node = 0; node < MAX_NUMA_NODES; ++node) {
+            if (allowed.Test(node)) {
+                node_ids[num_nodes++] = node;
+            }
+        }
+        const size_t parts = std::max<size_t>(1, placement_.parts);
+        for (size_t part = 0; part < parts; ++part) {
+            const size_t first = ParallelChunkBegin(n, parts, part) * sizeof(T) / PageSize() * PageSize();
+            const size_t last = part + 1 == parts ? size : ParallelChunkBegin(n, parts, part + 1) * sizeof(T) / PageSize() * PageSize();
+            if (first < last) {
+                NumaNodeMask nodes;
+                nodes.Set(node_ids[part * num_nodes / parts]);
+                NumaBind(ptr + first, last - first, NUMA_MPOL_PREFERRED, nodes);
+            }
+        }
+    }
+
+    static void Unmap(void* ptr, size_t bytes) noexcept {
+        munmap(ptr, PageRound(bytes));
+    }
+#else
+    static bool IsMapped(size_t /*bytes*/) noexcept {
+        return false;
+    }
+
+    static void* MapPlaced(size_t /*n*/) {
+        throw std::bad_alloc();
+    }
+
+    static void Unmap(void* /*ptr*/, size_t /*bytes*/) noexcept {
+    }
+#endif
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
+
+// Параметры параллельного выполнения операций над большими диапазонами элементов
+struct ParallelPolicy {
+    // Число потоков, включая вызывающий; 0 — по числу аппаратных потоков
+    size_t num_threads = 0;
+    // Меньше этого числа элементов на поток не выделяется: мелкие диапазоны
+    // обрабатываются в вызывающем потоке без накладных расходов на запуск потоков
+    size_t min_chunk = size_t(1) << 16;
+};
+
+inline constexpr ParallelPolicy PARALLEL{};
+
+// Число частей, на которые делится диапазон из n элементов
+inline size_t ParallelChunkCount(size_t n, const ParallelPolicy& policy) noexcept {
+    size_t num_threads = policy.num_threads;
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    const size_t max_chunks = n / std::max<size_t>(1, policy.min_chunk);
+    return std::max<size_t>(1, std::min(num_threads, max_chunks));
+}
+
+// Начало части chunk при делении n элементов на num_chunks почти равных частей
+inline size_t ParallelChunkBegin(size_t n, size_t num_chunks, size_t chunk) noexcept {
+    return n / num_chunks * chunk + std::min(chunk, n % num_chunks);
+}
+
+// Делит [0, n) на num_chunks частей и вызывает op(first, last) для каждой: первую —
+// в вызывающем потоке, остальные — в отдельных. Если поток запустить не удалось, его часть
+// выполняется в вызывающем. Возвращает после завершения всех частей, сохраняя исключение
+// части i в errors[i]. При errors == nullptr исключение завершает программу, как из noexcept
+template <typename Op>
+void ParallelForChunks(size_t n, size_t num_chunks, Op& op, std::exception_ptr* errors) noexcept {
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            op(ParallelChunkBegin(n, num_chunks, chunk), ParallelChunkBegin(n, num_chunks, chunk + 1));
+        } catch (...) {
+            if (errors == nullptr) {
+                std::terminate();
+            }
+            errors[chunk] = std::current_exception();
+        }
+    };
+    std::unique_ptr<std::thread[]> threads;
+    if (num_chunks > 1) {
+        try {
+            threads.reset(new std::thread[num_chunks - 1]);
+        } catch (...) {
+            // Без памяти под потоки все части выполняются в вызывающем потоке
+        }
+    }
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+        try {
+            if (threads == nullptr) {
+                throw std::bad_alloc();
+            }
+            threads[chunk - 1] = std::thread(run, chunk);
+        } catch (...) {
+            run(chunk);
+        }
+    }
+    run(0);
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+        if (threads != nullptr && threads[chunk - 1].joinable()) {
+            threads[chunk - 1].join();
+        }
+    }
+}
+
+// Выполняет op(first, last) для частей [0, n). Части не должны выбрасывать исключений
+template <typename Op>
+void ParallelFor(size_t n, const ParallelPolicy& policy, Op op) noexcept {
+    const size_t num_chunks = ParallelChunkCount(n, policy);
+    if (num_chunks == 1) {
+        op(size_t(0), n);
+        return;
+    }
+    ParallelForChunks(n, num_chunks, op, nullptr);
+}
+
+// Создаёт элементы [0, n) частями: construct(first, last) либо создаёт все элементы части,
+// либо, как std::uninitialized_*, уничтожает созданные и выбрасывает исключение. Если хотя бы
+// одна часть не удалась, успешно созданные части уничтожаются через destroy(first, last),
+// а первое исключение выбрасывается повторно
+template <typename Construct, typename Destroy>
+void ParallelConstruct(size_t n, const ParallelPolicy& policy, Construct construct, Destroy destroy) {
+    const size_t num_chunks = ParallelChunkCount(n, policy);
+    if (num_chunks == 1) {
+        construct(size_t(0), n);
+        return;
+    }
+    const std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[num_chunks]);
+    ParallelForChunks(n, num_chunks, construct, errors.get());
+    const auto failed = std::find_if(errors.get(), errors.get() + num_chunks, [](const std::exception_ptr& error) {
+        return error != nullptr;
+    });
+    if (failed == errors.get() + num_chunks) {
+        return;
+    }
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        if (errors[chunk] == nullptr) {
+            destroy(ParallelChunkBegin(n, num_chunks, chunk), ParallelChunkBegin(n, num_chunks, chunk + 1));
+        }
+    }
+    std::rethrow_exception(*failed);
+}
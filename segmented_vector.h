@@ -0,0 +1,246 @@
+#pragma once
+
+#include "vector.h"
+#include "index_iterator.h"
+
+#include <type_traits>
+#include <utility>
+
+// Число элементов в сегменте SegmentedVector по умолчанию: наибольшая степень двойки,
+// при которой сегмент занимает не больше 64 КиБ
+template <typename T>
+constexpr size_t DefaultSegmentSize() noexcept {
+    size_t size = 1;
+    while (size * 2 * sizeof(T) <= (size_t(64) << 10)) {
+        size *= 2;
+    }
+    return size;
+}
+
+// Вектор из сегментов RawMemory фиксированного размера SegmentSize. Рост добавляет новый сегмент
+// и никогда не переносит существующие элементы: ссылки и указатели на них остаются
+// действительными до удаления самих элементов, а время EmplaceBack не зависит от размера.
+// Индексация — O(1) через таблицу сегментов: номер сегмента и смещение получаются сдвигом
+// и маской. Итераторы хранят индекс и остаются действительными при росте
+template <typename T, typename Allocator = std::allocator<T>, size_t SegmentSize = DefaultSegmentSize<T>()>
+class SegmentedVector {
+    static_assert(SegmentSize > 0 && (SegmentSize & (SegmentSize - 1)) == 0, "SegmentSize must be a power of two");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Segment = RawMemory<T, Allocator>;
+
+public:
+    static constexpr size_t SEGMENT_SIZE = SegmentSize;
+
+    using allocator_type = Allocator;
+    using value_type = T;
+    using iterator = IndexIterator<SegmentedVector, T&>;
+    using const_iterator = IndexIterator<const SegmentedVector, const T&>;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator& alloc) noexcept
+        : alloc_(alloc)
+    {
+    }
+
+    // Делегирующий конструктор: если копирование элемента выбросит исключение,
+    // деструктор уничтожит уже скопированные
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        Reserve(other.size_);
+        other.ForEachRange([this](const T* first, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                EmplaceBack(first[i]);
+            }
+        });
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , segments_(std::move(other.segments_))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SegmentedVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        DestroyElements();
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        std::swap(alloc_, other.alloc_);
+        segments_.Swap(other.segments_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return segments_.Size() * SEGMENT_SIZE;
+    }
+
+    // Объём памяти в байтах под элементы и таблицу сегментов
+    size_t BytesAllocated() const noexcept {
+        return Capacity() * sizeof(T) + segments_.BytesAllocated();
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return segments_[index / SEGMENT_SIZE][index % SEGMENT_SIZE];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Выделяет сегменты, чтобы вместить new_capacity элементов. Элементы не переносятся
+    void Reserve(size_t new_capacity) {
+        const size_t num_segments = (new_capacity + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+        if (num_segments > segments_.Size()) {
+            segments_.Reserve(num_segments);
+            while (segments_.Size() < num_segments) {
+                segments_.EmplaceBack(SEGMENT_SIZE, alloc_);
+            }
+        }
+    }
+
+    // Освобождает сегменты, в которых не осталось элементов
+    void ShrinkToFit() {
+        const size_t num_segments = (size_ + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+        while (segments_.Size() > num_segments) {
+            segments_.PopBack();
+        }
+        segments_.ShrinkToFit();
+    }
+
+    // Удаляет все элементы. Сегменты сохраняются, если не запрошено освобождение памяти
+    void Clear(bool release_capacity = false) noexcept {
+        DestroyElements();
+        size_ = 0;
+        if (release_capacity) {
+            segments_.Clear(true);
+        }
+    }
+
+    // Новые элементы инициализируются значениями по умолчанию. Если конструктор
+    // выбросит исключение, добавленные элементы уничтожаются
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            while (size_ > new_size) {
+                PopBack();
+            }
+            return;
+        }
+        Reserve(new_size);
+        const size_t old_size = size_;
+        try {
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+        } catch (...) {
+            while (size_ > old_size) {
+                PopBack();
+            }
+            throw;
+        }
+    }
+
+    template <typename F>
+    void PushBack(F&& value) {
+        EmplaceBack(std::forward<F>(value));
+    }
+
+    // Аргументы могут ссылаться на элементы вектора: при росте они не перемещаются
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            segments_.EmplaceBack(SEGMENT_SIZE, alloc_);
+        }
+        T* slot = segments_[size_ / SEGMENT_SIZE] + size_ % SEGMENT_SIZE;
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(segments_[size_ / SEGMENT_SIZE] + size_ % SEGMENT_SIZE);
+    }
+
+    // Вызывает op(first, count) для непрерывного участка элементов каждого сегмента по порядку
+    template <typename Op>
+    void ForEachRange(Op op) {
+        for (size_t start = 0; start < size_; start += SEGMENT_SIZE) {
+            op(segments_[start / SEGMENT_SIZE].GetAddress(), std::min(SEGMENT_SIZE, size_ - start));
+        }
+    }
+
+    template <typename Op>
+    void ForEachRange(Op op) const {
+        for (size_t start = 0; start < size_; start += SEGMENT_SIZE) {
+            op(segments_[start / SEGMENT_SIZE].GetAddress(), std::min(SEGMENT_SIZE, size_ - start));
+        }
+    }
+
+private:
+    Allocator alloc_;
+    // Таблица сегментов; при её росте переносятся только описатели блоков, а не элементы
+    Vector<Segment> segments_;
+    size_t size_ = 0;
+
+    void DestroyElements() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            ForEachRange([](T* first, size_t count) {
+                std::destroy_n(first, count);
+            });
+        }
+    }
+};
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define VECTOR_SERIALIZATION_FD
+#endif
+
+// Двоичный формат Vector тривиально копируемых элементов: заголовок и сразу за ним
+// (с выравниванием по alignof(T)) содержимое буфера как есть. Порядок байтов — порядок
+// записавшей машины; читатель с другим порядком получает ошибку, а не переставленные байты
+struct SerializedHeader {
+    static constexpr char MAGIC[4] = {'V', 'E', 'C', 'S'};
+    static constexpr uint32_t ENDIANNESS = 0x01020304;
+    static constexpr uint16_t VERSION = 1;
+
+    char magic[4];
+    uint32_t endianness;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t element_size;
+    uint64_t count;
+    // Смещение первого элемента от начала заголовка
+    uint64_t data_offset;
+};
+
+static_assert(sizeof(SerializedHeader) == 32);
+
+// Данные не соответствуют формату или типу элементов
+class SerializationError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Массив элементов, лежащий в чужом буфере. Ничем не владеет и действителен, пока жив буфер
+template <typename T>
+class SerializedView {
+public:
+    SerializedView(const T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    const T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const T* begin() const noexcept {
+        return data_;
+    }
+
+    const T* end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+template <typename T>
+SerializedHeader MakeSerializedHeader(size_t count) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>, "Serialization requires a trivially copyable type");
+    SerializedHeader header{};
+    std::memcpy(header.magic, SerializedHeader::MAGIC, sizeof(header.magic));
+    header.endianness = SerializedHeader::ENDIANNESS;
+    header.version = SerializedHeader::VERSION;
+    header.element_size = sizeof(T);
+    header.count = count;
+    header.data_offset = (sizeof(SerializedHeader) + alignof(T) - 1) / alignof(T) * alignof(T);
+    return header;
+}
+
+// Проверяет заголовок и возвращает число элементов. available — сколько байт доступно
+// после заголовка, либо size_t(-1), если размер заранее неизвестен
+template <typename T>
+size_t CheckSerializedHeader(const SerializedHeader& header, size_t available) {
+    static_assert(std::is_trivially_copyable_v<T>, "Serialization requires a trivially copyable type");
+    if (std::memcmp(header.magic, SerializedHeader::MAGIC, sizeof(header.magic)) != 0) {
+        throw SerializationError("Not a serialized Vector");
+    }
+    if (header.endianness != SerializedHeader::ENDIANNESS) {
+        throw SerializationError("Serialized Vector has a different byte order");
+    }
+    if (header.version != SerializedHeader::VERSION) {
+        throw SerializationError("Unsupported serialized Vector version");
+    }
+    if (header.element_size != sizeof(T)) {
+        throw SerializationError("Serialized element size does not match sizeof(T)");
+    }
+    if (header.data_offset != MakeSerializedHeader<T>(0).data_offset
+        || header.count > (size_t(-1) - header.data_offset) / sizeof(T)) {
+        throw SerializationError("Corrupted serialized Vector header");
+    }
+    if (available != size_t(-1) && header.data_offset - sizeof(SerializedHeader) + header.count * sizeof(T) > available) {
+        throw SerializationError("Serialized Vector is truncated");
+    }
+    return static_cast<size_t>(header.count);
+}
+
+// Размер сериализованного вектора в байтах
+template <typename T, typename Allocator, typename Growth>
+size_t SerializedSize(const Vector<T, Allocator, Growth>& v) noexcept {
+    return MakeSerializedHeader<T>(v.Size()).data_offset + v.Size() * sizeof(T);
+}
+
+// Записывает вектор в out, где должно быть не меньше SerializedSize(v) байт
+template <typename T, typename Allocator, typename Growth>
+void Serialize(const Vector<T, Allocator, Growth>& v, void* out) noexcept {
+    const SerializedHeader header = MakeSerializedHeader<T>(v.Size());
+    auto* bytes = static_cast<unsigned char*>(out);
+    std::memcpy(bytes, &header, sizeof(header));
+    std::memset(bytes + sizeof(header), 0, header.data_offset - sizeof(header));
+    if (v.Size() != 0) {
+        std::memcpy(bytes + header.data_offset, static_cast<const void*>(v.begin()), v.Size() * sizeof(T));
+    }
+}
+
+// Возвращает массив элементов прямо в буфере data размера size, без копирования.
+// data должен быть выровнен так, чтобы элементы лежали по адресам, кратным alignof(T)
+template <typename T>
+SerializedView<T> DeserializeView(const void* data, size_t size) {
+    if (size < sizeof(SerializedHeader)) {
+        throw SerializationError("Serialized Vector is truncated");
+    }
+    SerializedHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const size_t count = CheckSerializedHeader<T>(header, size - sizeof(header));
+    const auto* elements = static_cast<const unsigned char*>(data) + header.data_offset;
+    if (reinterpret_cast<std::uintptr_t>(elements) % alignof(T) != 0) {
+        throw SerializationError("Serialized Vector buffer is misaligned for T");
+    }
+    return SerializedView<T>(reinterpret_cast<const T*>(elements), count);
+}
+
+// Превращает сериализованный вектор в буфере data размера size в Vector без копирования:
+// вектор владеет буфером и, когда тот станет не нужен, вызывает deleter(data).
+// Место в конце буфера после элементов становится запасом вместимости
+template <typename T, typename Deleter>
+Vector<T> DeserializeAdopt(void* data, size_t size, Deleter deleter) {
+    const SerializedView<T> view = DeserializeView<T>(data, size);
+    const size_t capacity = (size - MakeSerializedHeader<T>(0).data_offset) / sizeof(T);
+    Vector<T> v;
+    v.Adopt(const_cast<T*>(view.Data()), view.Size(), capacity, [data, deleter](T* /*buffer*/, size_t /*capacity*/) mutable {
+        deleter(data);
+    });
+    return v;
+}
+
+// Копирует сериализованный вектор из буфера data размера size
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DoublingGrowth>
+Vector<T, Allocator, Growth> Deserialize(const void* data, size_t size, const Allocator& alloc = Allocator()) {
+    if (size < sizeof(SerializedHeader)) {
+        throw SerializationError("Serialized Vector is truncated");
+    }
+    SerializedHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const size_t count = CheckSerializedHeader<T>(header, size - sizeof(header));
+    Vector<T, Allocator, Growth> v(alloc);
+    v.ResizeAndOverwrite(count, [&](T* buffer, size_t n) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(buffer), static_cast<const unsigned char*>(data) + header.data_offset,
+                        n * sizeof(T));
+        }
+        return n;
+    });
+    return v;
+}
+
+#if defined(VECTOR_SERIALIZATION_FD)
+// Записывает вектор в файловый дескриптор одним writev (повторяя его при частичной записи).
+// Ошибки записи выбрасываются как std::system_error
+template <typename T, typename Allocator, typename Growth>
+void Serialize(const Vector<T, Allocator, Growth>& v, int fd) {
+    const SerializedHeader header = MakeSerializedHeader<T>(v.Size());
+    // Заголовок вместе с выравнивающими нулями
+    unsigned char prefix[sizeof(SerializedHeader) + alignof(T)] = {};
+    std::memcpy(prefix, &header, sizeof(header));
+    iovec parts[2] = {
+        {prefix, static_cast<size_t>(header.data_offset)},
+        {const_cast<void*>(static_cast<const void*>(v.begin())), v.Size() * sizeof(T)},
+    };
+    iovec* part = parts;
+    int num_parts = v.Size() != 0 ? 2 : 1;
+    while (num_parts != 0) {
+        const ssize_t written = writev(fd, part, num_parts);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        size_t left = static_cast<size_t>(written);
+        for (; num_parts != 0 && left >= part->iov_len; ++part, --num_parts) {
+            left -= part->iov_len;
+        }
+        if (num_parts != 0) {
+            part->iov_base = static_cast<unsigned char*>(part->iov_base) + left;
+            part->iov_len -= left;
+        }
+    }
+}
+
+// Читает ровно bytes байт; конец файла раньше времени означает обрезанные данные
+inline void ReadSerializedBytes(int fd, void* out, size_t bytes) {
+    auto* pos = static_cast<unsigned char*>(out);
+    while (bytes != 0) {
+        const ssize_t result = read(fd, pos, bytes);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (result == 0) {
+            throw SerializationError("Serialized Vector is truncated");
+        }
+        pos += result;
+        bytes -= static_cast<size_t>(result);
+    }
+}
+
+// Сколько байт осталось до конца обычного файла от текущей позиции, либо size_t(-1),
+// если fd — канал, сокет или другой поток неизвестной длины
+inline size_t SerializedBytesLeft(int fd) noexcept {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return size_t(-1);
+    }
+    const off_t pos = lseek(fd, 0, SEEK_CUR);
+    return pos >= 0 && pos <= info.st_size ? static_cast<size_t>(info.st_size - pos) : size_t(-1);
+}
+
+// Сколько байт читается за первый шаг, когда длина потока неизвестна
+inline constexpr size_t SERIALIZED_READ_CHUNK = size_t(64) << 10;
+
+// Читает вектор из файлового дескриптора. Элементы читаются сразу в буфер вектора,
+// без промежуточной копии. Размер обычного файла проверяется до выделения памяти. Если длина
+// потока неизвестна, count из заголовка не проверить заранее, поэтому буфер растёт вдвое
+// по мере прихода данных: поддельный заголовок не заставит выделить больше, чем прочитано
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DoublingGrowth>
+Vector<T, Allocator, Growth> Deserialize(int fd, const Allocator& alloc = Allocator()) {
+    SerializedHeader header;
+    ReadSerializedBytes(fd, &header, sizeof(header));
+    const size_t available = SerializedBytesLeft(fd);
+    const size_t count = CheckSerializedHeader<T>(header, available);
+    unsigned char padding[alignof(T)];
+    ReadSerializedBytes(fd, padding, header.data_offset - sizeof(header));
+    Vector<T, Allocator, Growth> v(alloc);
+    const size_t min_chunk = available != size_t(-1) ? count : std::max<size_t>(1, SERIALIZED_READ_CHUNK / sizeof(T));
+    while (v.Size() < count) {
+        const size_t old_size = v.Size();
+        v.ResizeAndOverwrite(old_size + std::min(count - old_size, std::max(old_size, min_chunk)), [fd, old_size](T* buffer, size_t n) {
+            ReadSerializedBytes(fd, buffer + old_size, (n - old_size) * sizeof(T));
+            return n;
+        });
+    }
+    return v;
+}
+#endif
@@ -0,0 +1,523 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Векторизованные алгоритмы над непрерывными массивами арифметических типов.
+// Ядра написаны один раз на векторных расширениях GCC/Clang и собираются для нескольких
+// ширин регистров: SSE2 или NEON (базовый уровень платформы), AVX2 и AVX-512 (функции
+// с атрибутом target, выбираются во время выполнения по возможностям процессора).
+// На других компиляторах используется скалярная реализация
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_VECTOR_EXTENSIONS
+#define SIMD_INLINE __attribute__((always_inline)) inline
+#else
+#define SIMD_INLINE inline
+#endif
+
+#if defined(SIMD_VECTOR_EXTENSIONS) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86_DISPATCH
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+
+#if defined(SIMD_VECTOR_EXTENSIONS) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define SIMD_BASELINE_128
+#endif
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    NEON,
+    AVX2,
+    AVX512,
+};
+
+// Типы, которые обрабатывают ядра: целые, кроме bool, а также float и double
+template <typename T>
+inline constexpr bool IS_SIMD_ARITHMETIC = (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+                                           || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Ядра для регистров шириной Width байт
+#if defined(SIMD_VECTOR_EXTENSIONS)
+template <typename T, size_t Width>
+struct SimdKernels {
+    // Векторы читаются и пишутся поверх массива T (may_alias) через ссылки: передача широких
+    // векторов по значению между функциями с разным target меняла бы ABI
+    typedef T V __attribute__((vector_size(Width), may_alias));
+    typedef T UnalignedV __attribute__((vector_size(Width), aligned(alignof(T)), may_alias));
+    using Mask = decltype(V{} == V{});
+
+    static constexpr size_t LANES = Width / sizeof(T);
+
+    // Наибольшее число сравнений на дорожку, которое Count накапливает без переполнения
+    static constexpr size_t COUNT_BLOCK = sizeof(T) == 1 ? 127 : sizeof(T) == 2 ? 32767 : size_t(1) << 30;
+
+    SIMD_INLINE static bool IsAligned(const T* ptr) noexcept {
+        return reinterpret_cast<std::uintptr_t>(ptr) % Width == 0;
+    }
+
+    SIMD_INLINE static const UnalignedV& At(const T* ptr) noexcept {
+        return *reinterpret_cast<const UnalignedV*>(ptr);
+    }
+
+    SIMD_INLINE static const V& AtAligned(const T* ptr) noexcept {
+        return *reinterpret_cast<const V*>(ptr);
+    }
+
+    SIMD_INLINE static V& AtAligned(T* ptr) noexcept {
+        return *reinterpret_cast<V*>(ptr);
+    }
+
+    SIMD_INLINE static bool AnyTrue(const Mask& mask) noexcept {
+        uint64_t words[sizeof(Mask) / sizeof(uint64_t)];
+        std::memcpy(words, &mask, sizeof(Mask));
+        uint64_t any = 0;
+        for (uint64_t word : words) {
+            any |= word;
+        }
+        return any != 0;
+    }
+
+    // Во всех ядрах первые элементы до границы Width обрабатываются поштучно,
+    // а основной цикл читает и пишет выровненными блоками. Для векторов
+    // с AlignedAllocator<T, 64> такой головы нет
+
+    SIMD_INLINE static void Fill(T* data, size_t n, T value) noexcept {
+        size_t i = 0;
+        for (; i < n && !IsAligned(data + i); ++i) {
+            data[i] = value;
+        }
+        const V v = V{} + value;
+        for (; i + LANES <= n; i += LANES) {
+            AtAligned(data + i) = v;
+        }
+        for (; i < n; ++i) {
+            data[i] = value;
+        }
+    }
+
+    SIMD_INLINE static size_t Find(const T* data, size_t n, T value) noexcept {
+        size_t i = 0;
+        for (; i < n && !IsAligned(data + i); ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        const V v = V{} + value;
+        // Блок с совпадением досматривается поштучно
+        for (; i + LANES <= n && !AnyTrue(AtAligned(data + i) == v); i += LANES) {
+        }
+        for (; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    SIMD_INLINE static size_t Count(const T* data, size_t n, T value) noexcept {
+        size_t count = 0;
+        size_t i = 0;
+        for (; i < n && !IsAligned(data + i); ++i) {
+            count += data[i] == value;
+        }
+        const V v = V{} + value;
+        while (i + LANES <= n) {
+            // Истинная дорожка маски равна -1, поэтому вычитание маски прибавляет 1
+            Mask counters{};
+            for (size_t block = 0; block < COUNT_BLOCK && i + LANES <= n; ++block, i += LANES) {
+                counters -= AtAligned(data + i) == v;
+            }
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                count += static_cast<size_t>(counters[lane]);
+            }
+        }
+        for (; i < n; ++i) {
+            count += data[i] == value;
+        }
+        return count;
+    }
+
+    // Целые типы складываются как беззнаковые, то есть с переполнением по модулю
+    SIMD_INLINE static T Sum(const T* data, size_t n) noexcept {
+        T total{};
+        size_t i = 0;
+        for (; i < n && !IsAligned(data + i); ++i) {
+            total += data[i];
+        }
+        // Несколько независимых сумм скрывают задержку сложения
+        V sums[4] = {};
+        for (; i + 4 * LANES <= n; i += 4 * LANES) {
+            sums[0] += AtAligned(data + i);
+            sums[1] += AtAligned(data + i + LANES);
+            sums[2] += AtAligned(data + i + 2 * LANES);
+            sums[3] += AtAligned(data + i + 3 * LANES);
+        }
+        for (; i + LANES <= n; i += LANES) {
+            sums[0] += AtAligned(data + i);
+        }
+        const V sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            total += sum[lane];
+        }
+        for (; i < n; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+
+    template <bool IS_MIN>
+    SIMD_INLINE static T MinMax(const T* data, size_t n) noexcept {
+        const auto better = [](T lhs, T rhs) {
+            return IS_MIN ? lhs < rhs : rhs < lhs;
+        };
+        T best = data[0];
+        size_t i = 1;
+        for (; i < n && !IsAligned(data + i); ++i) {
+            best = better(data[i], best) ? data[i] : best;
+        }
+        V bests = V{} + best;
+        for (; i + LANES <= n; i += LANES) {
+            const V values = AtAligned(data + i);
+            if constexpr (IS_MIN) {
+                bests = values < bests ? values : bests;
+            } else {
+                bests = bests < values ? values : bests;
+            }
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            best = better(bests[lane], best) ? bests[lane] : best;
+        }
+        for (; i < n; ++i) {
+            best = better(data[i], best) ? data[i] : best;
+        }
+        return best;
+    }
+
+    // dst[i] = lhs[i] * rhs[i] при IS_MUL, иначе lhs[i] + rhs[i]; dst может совпадать с lhs или rhs
+    template <bool IS_MUL>
+    SIMD_INLINE static void Transform(const T* lhs, const T* rhs, size_t n, T* dst) noexcept {
+        size_t i = 0;
+        for (; i < n && !IsAligned(dst + i); ++i) {
+            dst[i] = IS_MUL ? lhs[i] * rhs[i] : lhs[i] + rhs[i];
+        }
+        for (; i + LANES <= n; i += LANES) {
+            if constexpr (IS_MUL) {
+                AtAligned(dst + i) = At(lhs + i) * At(rhs + i);
+            } else {
+                AtAligned(dst + i) = At(lhs + i) + At(rhs + i);
+            }
+        }
+        for (; i < n; ++i) {
+            dst[i] = IS_MUL ? lhs[i] * rhs[i] : lhs[i] + rhs[i];
+        }
+    }
+};
+#else
+template <typename T, size_t Width>
+struct SimdKernels;
+#endif
+
+// Скалярная реализация тех же ядер
+template <typename T>
+struct SimdKernels<T, 0> {
+    static void Fill(T* data, size_t n, T value) noexcept {
+        std::fill_n(data, n, value);
+    }
+
+    static size_t Find(const T* data, size_t n, T value) noexcept {
+        return std::find(data, data + n, value) - data;
+    }
+
+    static size_t Count(const T* data, size_t n, T value) noexcept {
+        return std::count(data, data + n, value);
+    }
+
+    static T Sum(const T* data, size_t n) noexcept {
+        T total{};
+        for (size_t i = 0; i < n; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+
+    template <bool IS_MIN>
+    static T MinMax(const T* data, size_t n) noexcept {
+        return IS_MIN ? *std::min_element(data, data + n) : *std::max_element(data, data + n);
+    }
+
+    template <bool IS_MUL>
+    static void Transform(const T* lhs, const T* rhs, size_t n, T* dst) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = IS_MUL ? lhs[i] * rhs[i] : lhs[i] + rhs[i];
+        }
+    }
+};
+
+// Интерфейс алгоритмов: перегрузки для указателей и для Vector.
+// Реализация выбирается один раз при первом вызове по возможностям процессора.
+// Сумма чисел с плавающей точкой вычисляется в другом порядке, чем при последовательном
+// сложении, поэтому может отличаться от него в младших разрядах. Результат Min и Max
+// для массивов с NaN не определён
+class Simd {
+public:
+    static SimdLevel Level() noexcept {
+        return CurrentLevel();
+    }
+
+    static bool IsSupported(SimdLevel level) noexcept {
+        switch (level) {
+            case SimdLevel::SCALAR:
+                return true;
+#if defined(SIMD_BASELINE_128) && defined(__SSE2__)
+            case SimdLevel::SSE2:
+                return true;
+#endif
+#if defined(SIMD_BASELINE_128) && defined(__ARM_NEON)
+            case SimdLevel::NEON:
+                return true;
+#endif
+#if defined(SIMD_X86_DISPATCH)
+            case SimdLevel::AVX2:
+                return __builtin_cpu_supports("avx2");
+            case SimdLevel::AVX512:
+                return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    // Принудительно выбирает реализацию, например для тестов и замеров.
+    // Возвращает false, если процессор или сборка её не поддерживают
+    static bool SetLevel(SimdLevel level) noexcept {
+        if (!IsSupported(level)) {
+            return false;
+        }
+        CurrentLevel() = level;
+        return true;
+    }
+
+    template <typename T>
+    static void Fill(T* data, size_t n, T value) noexcept {
+        Dispatch<FillOp>(data, n, value);
+    }
+
+    // Копирует n элементов из src в dst. Библиотечный memcpy уже векторизован
+    // и сам выбирает реализацию во время выполнения
+    template <typename T>
+    static void Copy(const T* src, size_t n, T* dst) noexcept {
+        static_assert(IS_SIMD_ARITHMETIC<T>);
+        if (n != 0) {
+            std::memcpy(dst, src, n * sizeof(T));
+        }
+    }
+
+    // Индекс первого элемента, равного value, либо n
+    template <typename T>
+    static size_t Find(const T* data, size_t n, T value) noexcept {
+        return Dispatch<FindOp>(data, n, value);
+    }
+
+    template <typename T>
+    static size_t Count(const T* data, size_t n, T value) noexcept {
+        return Dispatch<CountOp>(data, n, value);
+    }
+
+    template <typename T>
+    static T Sum(const T* data, size_t n) noexcept {
+        return static_cast<T>(Dispatch<SumOp>(AsWrapping(data), n));
+    }
+
+    template <typename T>
+    static T Min(const T* data, size_t n) noexcept {
+        assert(n != 0);
+        return Dispatch<MinMaxOp<true>>(data, n);
+    }
+
+    template <typename T>
+    static T Max(const T* data, size_t n) noexcept {
+        assert(n != 0);
+        return Dispatch<MinMaxOp<false>>(data, n);
+    }
+
+    // dst[i] = lhs[i] + rhs[i]; dst может совпадать с lhs или rhs
+    template <typename T>
+    static void Add(const T* lhs, const T* rhs, size_t n, T* dst) noexcept {
+        Dispatch<TransformOp<false>>(AsWrapping(lhs), AsWrapping(rhs), n, AsWrapping(dst));
+    }
+
+    // dst[i] = lhs[i] * rhs[i]; dst может совпадать с lhs или rhs
+    template <typename T>
+    static void Mul(const T* lhs, const T* rhs, size_t n, T* dst) noexcept {
+        Dispatch<TransformOp<true>>(AsWrapping(lhs), AsWrapping(rhs), n, AsWrapping(dst));
+    }
+
+    // Перегрузки для Vector. Тип значения не выводится из аргумента (common_type_t),
+    // чтобы можно было писать Simd::Fill(floats, 1)
+
+    template <typename T, typename Allocator, typename Growth>
+    static void Fill(Vector<T, Allocator, Growth>& v, const std::common_type_t<T>& value) noexcept {
+        Fill(v.begin(), v.Size(), value);
+    }
+
+    // Делает dst копией src
+    template <typename T, typename SrcAllocator, typename SrcGrowth, typename DstAllocator, typename DstGrowth>
+    static void Copy(const Vector<T, SrcAllocator, SrcGrowth>& src, Vector<T, DstAllocator, DstGrowth>& dst) {
+        dst.ResizeDefaultInit(src.Size());
+        Copy(src.begin(), src.Size(), dst.begin());
+    }
+
+    template <typename T, typename Allocator, typename Growth>
+    static typename Vector<T, Allocator, Growth>::const_iterator Find(const Vector<T, Allocator, Growth>& v,
+                                                                      const std::common_type_t<T>& value) noexcept {
+        return v.begin() + Find(v.begin(), v.Size(), value);
+    }
+
+    template <typename T, typename Allocator, typename Growth>
+    static size_t Count(const Vector<T, Allocator, Growth>& v, const std::common_type_t<T>& value) noexcept {
+        return Count(v.begin(), v.Size(), value);
+    }
+
+    template <typename T, typename Allocator, typename Growth>
+    static T Sum(const Vector<T, Allocator, Growth>& v) noexcept {
+        return Sum(v.begin(), v.Size());
+    }
+
+    template <typename T, typename Allocator, typename Growth>
+    static T Min(const Vector<T, Allocator, Growth>& v) noexcept {
+        return Min(v.begin(), v.Size());
+    }
+
+    template <typename T, typename Allocator, typename Growth>
+    static T Max(const Vector<T, Allocator, Growth>& v) noexcept {
+        return Max(v.begin(), v.Size());
+    }
+
+    // Записывает в dst поэлементную сумму векторов одинакового размера; dst может быть одним из них
+    template <typename T, typename Allocator, typename Growth>
+    static void Add(const Vector<T, Allocator, Growth>& lhs, const Vector<T, Allocator, Growth>& rhs,
+                    Vector<T, Allocator, Growth>& dst) {
+        assert(lhs.Size() == rhs.Size());
+        dst.ResizeDefaultInit(lhs.Size());
+        Add(lhs.begin(), rhs.begin(), lhs.Size(), dst.begin());
+    }
+
+    template <typename T, typename Allocator, typename Growth>
+    static void Mul(const Vector<T, Allocator, Growth>& lhs, const Vector<T, Allocator, Growth>& rhs,
+                    Vector<T, Allocator, Growth>& dst) {
+        assert(lhs.Size() == rhs.Size());
+        dst.ResizeDefaultInit(lhs.Size());
+        Mul(lhs.begin(), rhs.begin(), lhs.Size(), dst.begin());
+    }
+
+private:
+    // Операции, выполняемые ядрами ширины Width
+
+    struct FillOp {
+        template <size_t Width, typename T>
+        SIMD_INLINE static void Run(T* data, size_t n, T value) noexcept {
+            SimdKernels<T, Width>::Fill(data, n, value);
+        }
+    };
+
+    struct FindOp {
+        template <size_t Width, typename T>
+        SIMD_INLINE static size_t Run(const T* data, size_t n, T value) noexcept {
+            return SimdKernels<T, Width>::Find(data, n, value);
+        }
+    };
+
+    struct CountOp {
+        template <size_t Width, typename T>
+        SIMD_INLINE static size_t Run(const T* data, size_t n, T value) noexcept {
+            return SimdKernels<T, Width>::Count(data, n, value);
+        }
+    };
+
+    struct SumOp {
+        template <size_t Width, typename T>
+        SIMD_INLINE static T Run(const T* data, size_t n) noexcept {
+            return SimdKernels<T, Width>::Sum(data, n);
+        }
+    };
+
+    template <bool IS_MIN>
+    struct MinMaxOp {
+        template <size_t Width, typename T>
+        SIMD_INLINE static T Run(const T* data, size_t n) noexcept {
+            return SimdKernels<T, Width>::template MinMax<IS_MIN>(data, n);
+        }
+    };
+
+    template <bool IS_MUL>
+    struct TransformOp {
+        template <size_t Width, typename T>
+        SIMD_INLINE static void Run(const T* lhs, const T* rhs, size_t n, T* dst) noexcept {
+            SimdKernels<T, Width>::template Transform<IS_MUL>(lhs, rhs, n, dst);
+        }
+    };
+
+    // Арифметика над целыми выполняется в беззнаковом типе того же размера, где переполнение определено
+    template <typename T>
+    using Wrapping = std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::common_type<T>>;
+
+    template <typename T>
+    static auto AsWrapping(T* ptr) noexcept {
+        using U = typename Wrapping<std::remove_const_t<T>>::type;
+        using Pointer = std::conditional_t<std::is_const_v<T>, const U*, U*>;
+        return reinterpret_cast<Pointer>(ptr);
+    }
+
+    static SimdLevel DetectLevel() noexcept {
+        for (SimdLevel level : {SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE2, SimdLevel::NEON}) {
+            if (IsSupported(level)) {
+                return level;
+            }
+        }
+        return SimdLevel::SCALAR;
+    }
+
+    static SimdLevel& CurrentLevel() noexcept {
+        static SimdLevel level = DetectLevel();
+        return level;
+    }
+
+#if defined(SIMD_X86_DISPATCH)
+    template <typename Op, typename... Args>
+    SIMD_TARGET_AVX512 static auto RunAvx512(Args... args) noexcept {
+        return Op::template Run<64>(args...);
+    }
+
+    template <typename Op, typename... Args>
+    SIMD_TARGET_AVX2 static auto RunAvx2(Args... args) noexcept {
+        return Op::template Run<32>(args...);
+    }
+#endif
+
+    template <typename Op, typename T, typename... Args>
+    static auto Dispatch(T* data, Args... args) noexcept {
+        static_assert(IS_SIMD_ARITHMETIC<std::remove_const_t<T>>, "Simd algorithms require an arithmetic type");
+        switch (Level()) {
+#if defined(SIMD_X86_DISPATCH)
+            case SimdLevel::AVX512:
+                return RunAvx512<Op>(data, args...);
+            case SimdLevel::AVX2:
+                return RunAvx2<Op>(data, args...);
+#endif
+#if defined(SIMD_BASELINE_128)
+            case SimdLevel::SSE2:
+            case SimdLevel::NEON:
+                return Op::template Run<16>(data, args...);
+#endif
+            default:
+                return Op::template Run<0>(data, args...);
+        }
+    }
+};
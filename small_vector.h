@@ -0,0 +1,222 @@
+#pragma once
+
+#include "vector.h"
+
+// Встроенный буфер SmallVector на N элементов
+template <typename T, size_t N>
+struct SmallVectorBuffer {
+    SmallVectorBuffer() = default;
+    SmallVectorBuffer(const SmallVectorBuffer&) = delete;
+    SmallVectorBuffer& operator=(const SmallVectorBuffer&) = delete;
+
+    T* GetAddress() noexcept {
+        return reinterpret_cast<T*>(storage);
+    }
+
+    const T* GetAddress() const noexcept {
+        return reinterpret_cast<const T*>(storage);
+    }
+
+    alignas(T) unsigned char storage[N * sizeof(T)];
+    bool in_use = false;
+};
+
+// Аллокатор, выдающий встроенный буфер под блоки до N элементов и кучу под остальные.
+// Аллокаторы считаются равными: блок из кучи может освободить любой из них, а блок
+// во встроенном буфере SmallVector никогда не передаёт другому вектору. Сам аллокатор
+// не выходит за пределы своего SmallVector, поэтому чужой встроенный буфер он не видит
+template <typename T, size_t N>
+class InlineAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    explicit InlineAllocator(SmallVectorBuffer<T, N>* buffer) noexcept
+        : buffer_(buffer)
+        , inline_data_(buffer->GetAddress()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n <= N && !buffer_->in_use) {
+            buffer_->in_use = true;
+            return buffer_->GetAddress();
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    // Блок из кучи освобождается без обращения к буферу: функция освобождения из
+    // SmallVector::Release может пережить сам вектор
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (ptr == inline_data_) {
+            buffer_->in_use = false;
+        } else {
+            // launder скрывает от GCC связь указателя со встроенным буфером:
+            // иначе после встраивания он ложно предупреждает об освобождении не из кучи
+            std::allocator<T>().deallocate(std::launder(ptr), n);
+        }
+    }
+
+    bool operator==(const InlineAllocator& /*other*/) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const InlineAllocator& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    SmallVectorBuffer<T, N>* buffer_;
+    T* inline_data_;
+};
+
+// Вектор, хранящий до N элементов прямо в объекте и переходящий в кучу только при переполнении.
+// Все операции, кроме перемещения и обмена, выполняет Vector: встроенный буфер для него
+// выглядит как обычный блок, выделенный аллокатором. Vector — закрытая база: его копия или
+// обмен через ссылку на базу унесли бы аллокатор, указывающий на встроенный буфер этого
+// объекта, поэтому наружу открыты только операции, не выдающие аллокатор
+template <typename T, size_t N, typename Growth = DoublingGrowth>
+class SmallVector : private SmallVectorBuffer<T, N>, private Vector<T, InlineAllocator<T, N>, Growth> {
+    static_assert(N > 0, "SmallVector requires a non-empty inline buffer");
+
+    using Buffer = SmallVectorBuffer<T, N>;
+    using Base = Vector<T, InlineAllocator<T, N>, Growth>;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+
+    using Base::Adopt;
+    using Base::Append;
+    using Base::begin;
+    using Base::Capacity;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::Data;
+    using Base::Emplace;
+    using Base::EmplaceBack;
+    using Base::end;
+    using Base::Erase;
+    using Base::Insert;
+    using Base::operator[];
+    using Base::PopBack;
+    using Base::PushBack;
+    using Base::Reserve;
+    using Base::Resize;
+    using Base::ResizeAndOverwrite;
+    using Base::ResizeDefaultInit;
+    using Base::Size;
+    using Base::SwapErase;
+
+    SmallVector()
+        : Base(InlineAllocator<T, N>(static_cast<Buffer*>(this)))
+    {
+        Base::Reserve(N);
+    }
+
+    explicit SmallVector(size_t size)
+        : SmallVector()
+    {
+        Base::Reserve(size);
+        Base::Resize(size);
+    }
+
+    SmallVector(const SmallVector& other)
+        : SmallVector()
+    {
+        Base::operator=(other);
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : SmallVector()
+    {
+        MoveFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        Base::operator=(rhs);
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                       && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &rhs) {
+            MoveFrom(rhs);
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                           && std::is_nothrow_move_assignable_v<T>) {
+        if (!IsInline() && !other.IsInline()) {
+            Base::Swap(other);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    // Возвращает элементы во встроенный буфер, если они в нём помещаются
+    void ShrinkToFit() {
+        if (!IsInline()) {
+            Base::ChangeCapacity(std::max(Base::Size(), N));
+        }
+    }
+
+    void Clear(bool release_capacity = false) noexcept {
+        Base::Clear(release_capacity);
+        if (release_capacity) {
+            Base::Reserve(N);
+        }
+    }
+
+    // Встроенный буфер отдать нельзя, поэтому элементы из него сначала переносятся в блок
+    // из кучи. После Release вектор пуст и снова хранит элементы во встроенном буфере
+    VectorBuffer<T> Release() {
+        if (IsInline()) {
+            if (Base::Size() == 0) {
+                return {};
+            }
+            Base::ChangeCapacity(N + 1);
+        }
+        VectorBuffer<T> buffer = Base::Release();
+        Base::Reserve(N);
+        return buffer;
+    }
+
+    // Встроенный буфер не считается: учитывается только память из кучи
+    size_t BytesAllocated() const noexcept {
+        return IsInline() ? 0 : Base::BytesAllocated();
+    }
+
+    // Проверяет, находятся ли элементы во встроенном буфере
+    bool IsInline() const noexcept {
+        return Base::begin() == Buffer::GetAddress();
+    }
+
+private:
+    void MoveFrom(SmallVector& other) {
+        if (other.IsInline()) {
+            // Чужой встроенный буфер забрать нельзя: элементы перемещаются поштучно
+            Base::Resize(0);
+            Base::Reserve(other.Size());
+            for (T& value : other) {
+                Base::EmplaceBack(std::move(value));
+            }
+            other.Resize(0);
+        } else {
+            Base::operator=(std::move(static_cast<Base&>(other)));
+            // Блок из кучи передан, other возвращается к своему встроенному буферу
+            other.Reserve(N);
+        }
+    }
+};
+
+// EraseIf для SmallVector: его база Vector закрыта
+template <typename T, size_t N, typename Growth, typename Predicate>
+size_t EraseIf(SmallVector<T, N, Growth>& vector, Predicate pred) {
+    auto new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t count = vector.end() - new_end;
+    vector.Erase(new_end, vector.end());
+    return count;
+}
@@ -0,0 +1,401 @@
+#pragma once
+
+#include "vector.h"
+#include "index_iterator.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Непрерывный участок элементов одного столбца SoAVector. Ничем не владеет
+// и становится недействительным при перевыделении памяти вектора
+template <typename T>
+class ColumnSpan {
+public:
+    ColumnSpan(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    T* begin() const noexcept {
+        return data_;
+    }
+
+    T* end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Вектор записей из полей Fields..., хранящий каждое поле в отдельном столбце RawMemory
+// (structure of arrays). Цикл по одному-двум полям читает только их столбцы, а не записи целиком.
+// Размер и вместимость общие для всех столбцов, память растёт по общей стратегии Growth.
+// Строка — кортеж ссылок на поля: operator[] и итераторы возвращают std::tuple<Fields&...>.
+// Элементы столбцов переносятся при перевыделении так же, как в Vector
+template <typename Growth, typename... Fields>
+class BasicSoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector requires at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    // Итератор по строкам: разыменование даёт кортеж ссылок на поля строки
+    using iterator = IndexIterator<BasicSoAVector, reference>;
+    using const_iterator = IndexIterator<const BasicSoAVector, const_reference>;
+
+    BasicSoAVector() = default;
+
+    BasicSoAVector(const BasicSoAVector& other)
+        : columns_(AllocateColumns(other.size_))
+    {
+        ForEachColumnOrUndo([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            std::uninitialized_copy_n(std::get<I>(other.columns_).GetAddress(), other.size_, Column<I>().Data());
+        }, [&](auto i) noexcept {
+            std::destroy_n(std::get<decltype(i)::value>(columns_).GetAddress(), other.size_);
+        });
+        size_ = other.size_;
+    }
+
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    BasicSoAVector& operator=(const BasicSoAVector& rhs) {
+        if (this != &rhs) {
+            BasicSoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    BasicSoAVector& operator=(BasicSoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            BasicSoAVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~BasicSoAVector() {
+        DestroyRows(0, size_);
+    }
+
+    void Swap(BasicSoAVector& other) noexcept {
+        ForEachColumn([&](auto i) {
+            std::get<decltype(i)::value>(columns_).Swap(std::get<decltype(i)::value>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    // Объём памяти в байтах, удерживаемой всеми столбцами
+    size_t BytesAllocated() const noexcept {
+        return Capacity() * ROW_SIZE;
+    }
+
+    // Элементы поля I всех строк
+    template <size_t I>
+    ColumnSpan<Field<I>> Column() noexcept {
+        return ColumnSpan<Field<I>>(std::get<I>(columns_).GetAddress(), size_);
+    }
+
+    template <size_t I>
+    ColumnSpan<const Field<I>> Column() const noexcept {
+        return ColumnSpan<const Field<I>>(std::get<I>(columns_).GetAddress(), size_);
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return MakeRow<reference>(columns_, index, std::index_sequence_for<Fields...>());
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return MakeRow<const_reference>(columns_, index, std::index_sequence_for<Fields...>());
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            Columns new_columns = AllocateColumns(new_capacity);
+            TransferTo(new_columns);
+        }
+    }
+
+    // Удаляет все строки. Вместимость сохраняется, если не запрошено освобождение памяти
+    void Clear(bool release_capacity = false) noexcept {
+        DestroyRows(0, size_);
+        size_ = 0;
+        if (release_capacity) {
+            columns_ = Columns();
+        }
+    }
+
+    // Новые строки инициализируются значениями по умолчанию
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyRows(new_size, size_);
+        } else if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(NextCapacity(new_size));
+            }
+            ForEachColumnOrUndo([&](auto i) {
+                std::uninitialized_value_construct_n(Column<decltype(i)::value>().end(), new_size - size_);
+            }, [&](auto i) noexcept {
+                std::destroy_n(Column<decltype(i)::value>().end(), new_size - size_);
+            });
+        }
+        size_ = new_size;
+    }
+
+    // Добавляет строку, создавая каждое поле из соответствующего аргумента
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "EmplaceBack takes one argument per field");
+        if (size_ < Capacity()) {
+            ConstructRow(columns_, size_, std::forward_as_tuple(std::forward<Args>(args)...));
+        } else {
+            Columns new_columns = AllocateColumns(NextCapacity(size_ + 1));
+            // Строка создаётся до переноса: аргументы могут ссылаться на элементы в старых столбцах
+            ConstructRow(new_columns, size_, std::forward_as_tuple(std::forward<Args>(args)...));
+            try {
+                TransferTo(new_columns);
+            } catch (...) {
+                DestroyRow(new_columns, size_);
+                throw;
+            }
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const value_type& row) {
+        std::apply([this](const Fields&... fields) {
+            EmplaceBack(fields...);
+        }, row);
+    }
+
+    void PushBack(value_type&& row) {
+        std::apply([this](Fields&... fields) {
+            EmplaceBack(std::move(fields)...);
+        }, row);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        DestroyRows(size_ - 1, size_);
+        --size_;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет строки [first, last), сдвигая хвост каждого столбца один раз.
+    // Если перемещающее присваивание поля выбросит исключение, строки могут рассогласоваться
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t i = first - cbegin();
+        const size_t count = last - first;
+        if (count == 0) {
+            return begin() + i;
+        }
+        ForEachColumn([&](auto column_index) {
+            using T = Field<decltype(column_index)::value>;
+            T* data = Column<decltype(column_index)::value>().Data();
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                std::destroy_n(data + i, count);
+                RelocateTrivially(data + i + count, size_ - i - count, data + i);
+            } else {
+                std::move(data + i + count, data + size_, data + i);
+                std::destroy_n(data + size_ - count, count);
+            }
+        });
+        size_ -= count;
+        return begin() + i;
+    }
+
+private:
+    static constexpr size_t ROW_SIZE = (sizeof(Fields) + ...);
+
+    // Способ переноса элементов поля I при перевыделении, как в Vector
+    template <size_t I>
+    static constexpr RelocationKind FIELD_RELOCATION_KIND = RELOCATION_KIND_OF<Field<I>>;
+
+    Columns columns_;
+    size_t size_ = 0;
+
+    static Columns AllocateColumns(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, ROW_SIZE);
+    }
+
+    // Вызывает op(std::integral_constant<size_t, I>) для каждого столбца I по порядку
+    template <typename Op>
+    static void ForEachColumn(Op&& op) {
+        ForEachColumnImpl(op, std::index_sequence_for<Fields...>());
+    }
+
+    template <typename Op, size_t... I>
+    static void ForEachColumnImpl(Op& op, std::index_sequence<I...>) {
+        (op(std::integral_constant<size_t, I>()), ...);
+    }
+
+    // Вызывает construct для каждого столбца. Если он выбросит исключение,
+    // вызывает destroy для столбцов, где construct уже завершился, и выбрасывает его повторно
+    template <typename Construct, typename Destroy>
+    static void ForEachColumnOrUndo(Construct construct, Destroy destroy) {
+        size_t done = 0;
+        try {
+            ForEachColumn([&](auto i) {
+                construct(i);
+                ++done;
+            });
+        } catch (...) {
+            ForEachColumn([&](auto i) {
+                if (decltype(i)::value < done) {
+                    destroy(i);
+                }
+            });
+            throw;
+        }
+    }
+
+    template <typename Row, typename ColumnsTuple, size_t... I>
+    static Row MakeRow(ColumnsTuple& columns, size_t index, std::index_sequence<I...>) noexcept {
+        return Row(std::get<I>(columns)[index]...);
+    }
+
+    // Создаёт строку index в columns из кортежа аргументов values, по одному на поле
+    template <typename Values>
+    static void ConstructRow(Columns& columns, size_t index, Values&& values) {
+        ForEachColumnOrUndo([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            new (std::get<I>(columns) + index) Field<I>(std::get<I>(std::forward<Values>(values)));
+        }, [&](auto i) noexcept {
+            std::destroy_at(std::get<decltype(i)::value>(columns) + index);
+        });
+    }
+
+    static void DestroyRow(Columns& columns, size_t index) noexcept {
+        ForEachColumn([&](auto i) {
+            std::destroy_at(std::get<decltype(i)::value>(columns) + index);
+        });
+    }
+
+    void DestroyRows(size_t first, size_t last) noexcept {
+        ForEachColumn([&](auto i) {
+            std::destroy_n(std::get<decltype(i)::value>(columns_) + first, last - first);
+        });
+    }
+
+    // Переносит строки в new_columns и делает их текущими. Сначала копируются столбцы,
+    // которые нельзя безопасно переместить: если копирование выбросит исключение,
+    // вектор остаётся прежним. Затем перемещаются и побайтово переносятся остальные
+    void TransferTo(Columns& new_columns) {
+        const auto destroy_new = [&](auto i) noexcept {
+            std::destroy_n(std::get<decltype(i)::value>(new_columns).GetAddress(), size_);
+        };
+        ForEachColumnOrUndo([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            if constexpr (FIELD_RELOCATION_KIND<I> == RelocationKind::COPY) {
+                UninitializedCopyForRelocation(std::get<I>(columns_).GetAddress(), size_, std::get<I>(new_columns).GetAddress());
+            }
+        }, [&](auto i) noexcept {
+            if constexpr (FIELD_RELOCATION_KIND<decltype(i)::value> == RelocationKind::COPY) {
+                destroy_new(i);
+            }
+        });
+        try {
+            ForEachColumnOrUndo([&](auto i) {
+                constexpr size_t I = decltype(i)::value;
+                if constexpr (FIELD_RELOCATION_KIND<I> == RelocationKind::MOVE) {
+                    std::uninitialized_move_n(std::get<I>(columns_).GetAddress(), size_, std::get<I>(new_columns).GetAddress());
+                }
+            }, [&](auto i) noexcept {
+                if constexpr (FIELD_RELOCATION_KIND<decltype(i)::value> == RelocationKind::MOVE) {
+                    destroy_new(i);
+                }
+            });
+        } catch (...) {
+            ForEachColumn([&](auto i) {
+                if constexpr (FIELD_RELOCATION_KIND<decltype(i)::value> == RelocationKind::COPY) {
+                    destroy_new(i);
+                }
+            });
+            throw;
+        }
+        ForEachColumn([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            if constexpr (FIELD_RELOCATION_KIND<I> == RelocationKind::BITWISE) {
+                RelocateTrivially(std::get<I>(columns_).GetAddress(), size_, std::get<I>(new_columns).GetAddress());
+            } else {
+                std::destroy_n(std::get<I>(columns_).GetAddress(), size_);
+            }
+            std::get<I>(columns_).Swap(std::get<I>(new_columns));
+        });
+    }
+};
+
+template <typename... Fields>
+using SoAVector = BasicSoAVector<DoublingGrowth, Fields...>;
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "vector.h"
+
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Элементы StaticVector хранятся в обычном массиве T[N], если T создаётся по умолчанию,
+// присваивается и тривиально уничтожается. Ячейки за пределами размера тогда содержат
+// значения по умолчанию, а сам вектор может быть константой времени компиляции
+template <typename T>
+inline constexpr bool STATIC_VECTOR_USES_ARRAY = std::is_default_constructible_v<T>
+    && std::is_trivially_destructible_v<T> && std::is_move_assignable_v<T>;
+
+template <typename T, size_t N, bool USES_ARRAY = STATIC_VECTOR_USES_ARRAY<T>>
+class StaticVectorStorage {
+protected:
+    constexpr T* Data() noexcept {
+        return elements_;
+    }
+
+    constexpr const T* Data() const noexcept {
+        return elements_;
+    }
+
+    template <typename... Args>
+    constexpr T& Construct(size_t index, Args&&... args) {
+        elements_[index] = T(std::forward<Args>(args)...);
+        return elements_[index];
+    }
+
+    constexpr void Destroy(size_t index) noexcept {
+        // Освобождённая ячейка снова содержит значение по умолчанию
+        elements_[index] = T();
+    }
+
+    T elements_[N] = {};
+    size_t size_ = 0;
+};
+
+// Хранилище для остальных типов: неинициализированная память под N элементов
+template <typename T, size_t N>
+class StaticVectorStorage<T, N, false> {
+protected:
+    StaticVectorStorage() = default;
+
+    StaticVectorStorage(const StaticVectorStorage& other) {
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    StaticVectorStorage(StaticVectorStorage&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        std::uninitialized_move_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    StaticVectorStorage& operator=(const StaticVectorStorage& rhs) {
+        if (this != &rhs) {
+            StaticVectorStorage rhs_copy(rhs);
+            *this = std::move(rhs_copy);
+        }
+        return *this;
+    }
+
+    StaticVectorStorage& operator=(StaticVectorStorage&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            std::destroy_n(Data(), size_);
+            size_ = 0;
+            std::uninitialized_move_n(rhs.Data(), rhs.size_, Data());
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    ~StaticVectorStorage() {
+        std::destroy_n(Data(), size_);
+    }
+
+    T* Data() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    const T* Data() const noexcept {
+        return std::launder(reinterpret_cast<const T*>(storage_));
+    }
+
+    template <typename... Args>
+    T& Construct(size_t index, Args&&... args) {
+        return *new (static_cast<void*>(Data() + index)) T(std::forward<Args>(args)...);
+    }
+
+    void Destroy(size_t index) noexcept {
+        std::destroy_at(Data() + index);
+    }
+
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+    size_t size_ = 0;
+};
+
+// Вектор с вместимостью N, хранящий элементы прямо в объекте и никогда не выделяющий память.
+// Добавление сверх вместимости выбрасывает std::length_error (в константном выражении это
+// ошибка компиляции). Для типов, подходящих под STATIC_VECTOR_USES_ARRAY, все операции
+// constexpr уже в C++17, и таблицы можно строить при компиляции:
+//     constexpr auto SQUARES = [] {
+//         StaticVector<int, 16> v;
+//         for (int i = 0; i < 16; ++i) v.PushBack(i * i);
+//         return v;
+//     }();
+template <typename T, size_t N>
+class StaticVector : private StaticVectorStorage<T, N> {
+    static_assert(N > 0, "StaticVector requires a non-zero capacity");
+
+    using Storage = StaticVectorStorage<T, N>;
+    using Storage::size_;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr StaticVector() = default;
+
+    constexpr StaticVector(std::initializer_list<T> values) {
+        for (const T& value : values) {
+            EmplaceBack(value);
+        }
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    constexpr T* Data() noexcept {
+        return Storage::Data();
+    }
+
+    constexpr const T* Data() const noexcept {
+        return Storage::Data();
+    }
+
+    constexpr T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr iterator begin() noexcept {
+        return Data();
+    }
+
+    constexpr iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return Data();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return end();
+    }
+
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        if (size_ == N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+        T& value = Storage::Construct(size_, std::forward<Args>(args)...);
+        ++size_;
+        return value;
+    }
+
+    template <typename F>
+    constexpr void PushBack(F&& value) {
+        EmplaceBack(std::forward<F>(value));
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_ > 0);
+        Storage::Destroy(--size_);
+    }
+
+    constexpr void Clear() noexcept {
+        while (size_ > 0) {
+            PopBack();
+        }
+    }
+
+    // Новые элементы инициализируются значениями по умолчанию
+    constexpr void Resize(size_t new_size) {
+        if (new_size > N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+        while (size_ > new_size) {
+            PopBack();
+        }
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    constexpr iterator Erase(const_iterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        const size_t i = pos - cbegin();
+        for (size_t j = i; j + 1 < size_; ++j) {
+            Data()[j] = std::move(Data()[j + 1]);
+        }
+        PopBack();
+        return begin() + i;
+    }
+};
@@ -2,122 +2,707 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <new>
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <type_traits>
 
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include "parallel.h"
+
+#if defined(VECTOR_ENABLE_STATS)
+#include <atomic>
+#endif
+
+// В C++20 RawMemory и основные операции Vector (создание, копирование, PushBack, EmplaceBack,
+// PopBack, Reserve, Resize, Clear, доступ к элементам) можно вызывать в константных выражениях.
+// Память, выделенная при таком вычислении, должна быть освобождена до его окончания
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define VECTOR_CONSTEXPR constexpr
+#else
+#define VECTOR_CONSTEXPR
+#endif
+
+// Выполняется ли вызов при вычислении константного выражения
+constexpr bool IsConstantEvaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+// Создаёт объект в неинициализированной памяти ptr; в C++20 — и в константных выражениях
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR T* ConstructAt(T* ptr, Args&&... args) {
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+    return std::construct_at(ptr, std::forward<Args>(args)...);
+#else
+    return new (static_cast<void*>(ptr)) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Аналоги std::uninitialized_*, которые в C++20 ещё не constexpr. Исключение делает
+// константное выражение некорректным, поэтому при вычислении в нём откат не нужен
+template <typename InputIt, typename T>
+VECTOR_CONSTEXPR void UninitializedCopyN(InputIt first, size_t n, T* dest) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i, ++first) {
+            ConstructAt(dest + i, *first);
+        }
+    } else {
+        std::uninitialized_copy_n(first, n, dest);
+    }
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedMoveN(T* first, size_t n, T* dest) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(dest + i, std::move(first[i]));
+        }
+    } else {
+        std::uninitialized_move_n(first, n, dest);
+    }
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedValueConstructN(T* first, size_t n) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(first + i);
+        }
+    } else {
+        std::uninitialized_value_construct_n(first, n);
+    }
+}
+
+// Тип называется тривиально перемещаемым, если перенос объекта в другую память
+// можно выполнить побайтовым копированием, не вызывая для старого объекта деструктор.
+// Для своих типов, удовлетворяющих этому условию, специализируйте шаблон:
+//     template <> struct IsTriviallyRelocatable<MyType> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {};
+
+// Переносит n тривиально перемещаемых объектов из src в неинициализированную память dst.
+// Исходные объекты после вызова считаются уничтоженными. В константном выражении,
+// где побайтовое копирование недоступно, объекты перемещаются поштучно, и диапазоны
+// не должны перекрываться
+template <typename T>
+VECTOR_CONSTEXPR void RelocateTrivially(T* src, size_t n, T* dst) noexcept {
+    static_assert(IsTriviallyRelocatable<T>::value);
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(dst + i, std::move(src[i]));
+            std::destroy_at(src + i);
+        }
+    } else if (n != 0) {
+        std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+    }
+}
+
+// Если перемещающий конструктор T может выбросить исключение, при перераспределении памяти
+// Vector копирует элементы, чтобы сохранить строгую гарантию. Специализация с true_type
+// разрешает перемещать их и в этом случае: при исключении вектор остаётся в прежнем блоке,
+// но часть его элементов окажется в состоянии после перемещения (базовая гарантия).
+//     template <> struct MoveEvenIfThrows<MyType> : std::true_type {};
+// При определённом макросе VECTOR_STRICT_RELOCATION копирование при перераспределении
+// становится ошибкой компиляции
+template <typename T>
+struct MoveEvenIfThrows : std::false_type {};
+
+// Аллокатор может дополнительно предоставлять метод reallocate(p, old_n, new_n), который
+// изменяет размер блока, сохраняя его содержимое побайтово (как realloc). Тогда блоки
+// с тривиально перемещаемыми элементами растут на месте, без выделения нового блока
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+    std::declval<typename std::allocator_traits<Allocator>::pointer>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// Способ, которым элементы переносятся в новый блок при перераспределении памяти
+enum class RelocationKind {
+    // Перемещающим конструктором
+    MOVE,
+    // Копирующим конструктором, так как перемещающий может выбросить исключение
+    COPY,
+    // Побайтово, для тривиально перемещаемых типов
+    BITWISE,
+};
+
+// Перемещаются ли элементы T в новый блок при перераспределении памяти. Копирование
+// остаётся только там, где перемещение может выбросить исключение, а T копируем
+template <typename T>
+struct RelocatesByMove
+    : std::bool_constant<std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>
+                         || MoveEvenIfThrows<T>::value> {};
+
+// Способ переноса элементов T при перераспределении памяти; общий для всех контейнеров
+template <typename T>
+inline constexpr RelocationKind RELOCATION_KIND_OF =
+    IsTriviallyRelocatable<T>::value ? RelocationKind::BITWISE
+    : RelocatesByMove<T>::value ? RelocationKind::MOVE
+    : RelocationKind::COPY;
+
+// Копирует n элементов в новый блок, когда RELOCATION_KIND_OF<T> == RelocationKind::COPY.
+// Здесь срабатывает проверка VECTOR_STRICT_RELOCATION
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedCopyForRelocation(const T* first, size_t n, T* dest) {
+#if defined(VECTOR_STRICT_RELOCATION)
+    static_assert(RelocatesByMove<T>::value, "Vector copies elements on reallocation: make the move "
+                  "constructor of T noexcept or specialize MoveEvenIfThrows<T>");
+#endif
+    UninitializedCopyN(first, n, dest);
+}
+
+// Суммарная статистика всех векторов программы
+struct VectorStats {
+    size_t reallocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_freed = 0;
+    size_t elements_moved = 0;
+    size_t elements_copied = 0;
+    size_t elements_relocated = 0;
+    // Размер самого большого выделенного блока в байтах
+    size_t peak_capacity_bytes = 0;
+};
+
+// Одно перераспределение памяти вектора container
+struct ReallocationEvent {
+    const void* container;
+    size_t element_size;
+    size_t old_capacity;
+    size_t new_capacity;
+    size_t elements;
+    RelocationKind kind;
+};
+
+using ReallocationHook = void (*)(const ReallocationEvent& event);
+
+// Инструментирование RawMemory и Vector. Включается макросом VECTOR_ENABLE_STATS, который должен
+// быть одинаково определён во всех единицах трансляции программы. Без него запись ничего не делает,
+// а GetStats возвращает нули. Обработчик вызывается при каждом перераспределении и позволяет
+// найти конкретные векторы, которые часто растут или копируют элементы вместо перемещения
+class VectorInstrumentation {
+public:
+#if defined(VECTOR_ENABLE_STATS)
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    static VectorStats GetStats() noexcept {
+        VectorStats stats;
+#if defined(VECTOR_ENABLE_STATS)
+        const Counters& counters = GetCounters();
+        stats.reallocations = counters.reallocations.load(std::memory_order_relaxed);
+        stats.bytes_allocated = counters.bytes_allocated.load(std::memory_order_relaxed);
+        stats.bytes_freed = counters.bytes_freed.load(std::memory_order_relaxed);
+        stats.elements_moved = counters.elements_moved.load(std::memory_order_relaxed);
+        stats.elements_copied = counters.elements_copied.load(std::memory_order_relaxed);
+        stats.elements_relocated = counters.elements_relocated.load(std::memory_order_relaxed);
+        stats.peak_capacity_bytes = counters.peak_capacity_bytes.load(std::memory_order_relaxed);
+#endif
+        return stats;
+    }
+
+    static void ResetStats() noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        Counters& counters = GetCounters();
+        counters.reallocations = 0;
+        counters.bytes_allocated = 0;
+        counters.bytes_freed = 0;
+        counters.elements_moved = 0;
+        counters.elements_copied = 0;
+        counters.elements_relocated = 0;
+        counters.peak_capacity_bytes = 0;
+#endif
+    }
+
+    // Устанавливает обработчик перераспределений, nullptr отключает его
+    static void SetReallocationHook([[maybe_unused]] ReallocationHook hook) noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        GetCounters().hook = hook;
+#endif
+    }
+
+    static VECTOR_CONSTEXPR void OnAllocate([[maybe_unused]] size_t bytes) noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        if (IsConstantEvaluated()) {
+            return;
+        }
+        Counters& counters = GetCounters();
+        counters.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        size_t peak = counters.peak_capacity_bytes.load(std::memory_order_relaxed);
+        while (peak < bytes && !counters.peak_capacity_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+#endif
+    }
+
+    static VECTOR_CONSTEXPR void OnDeallocate([[maybe_unused]] size_t bytes) noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        if (IsConstantEvaluated()) {
+            return;
+        }
+        GetCounters().bytes_freed.fetch_add(bytes, std::memory_order_relaxed);
+#endif
+    }
+
+    static VECTOR_CONSTEXPR void OnReallocation([[maybe_unused]] const ReallocationEvent& event) noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        if (IsConstantEvaluated()) {
+            return;
+        }
+        Counters& counters = GetCounters();
+        counters.reallocations.fetch_add(1, std::memory_order_relaxed);
+        switch (event.kind) {
+            case RelocationKind::MOVE:
+                counters.elements_moved.fetch_add(event.elements, std::memory_order_relaxed);
+                break;
+            case RelocationKind::COPY:
+                counters.elements_copied.fetch_add(event.elements, std::memory_order_relaxed);
+                break;
+            case RelocationKind::BITWISE:
+                counters.elements_relocated.fetch_add(event.elements, std::memory_order_relaxed);
+                break;
+        }
+        if (ReallocationHook hook = counters.hook.load(std::memory_order_relaxed)) {
+            hook(event);
+        }
+#endif
+    }
+
+private:
+#if defined(VECTOR_ENABLE_STATS)
+    struct Counters {
+        std::atomic<size_t> reallocations{0};
+        std::atomic<size_t> bytes_allocated{0};
+        std::atomic<size_t> bytes_freed{0};
+        std::atomic<size_t> elements_moved{0};
+        std::atomic<size_t> elements_copied{0};
+        std::atomic<size_t> elements_relocated{0};
+        std::atomic<size_t> peak_capacity_bytes{0};
+        std::atomic<ReallocationHook> hook{nullptr};
+    };
+
+    static Counters& GetCounters() noexcept {
+        static Counters counters;
+        return counters;
+    }
+#endif
+};
+
+// Аллокатор может также предоставлять метод expand(p, old_n, new_n), который увеличивает блок
+// на месте, не перемещая его, и возвращает false, если это невозможно. Тогда Vector в первую
+// очередь пытается расти так, для элементов любого типа
+template <typename Allocator, typename = void>
+struct HasExpand : std::false_type {};
+
+template <typename Allocator>
+struct HasExpand<Allocator, std::void_t<decltype(std::declval<Allocator&>().expand(
+    std::declval<typename std::allocator_traits<Allocator>::pointer>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// Освобождает память блока buffer вместимостью capacity элементов. Элементы к моменту вызова
+// уже уничтожены владельцем блока
 template <typename T>
+using BufferDeleter = std::function<void(T* buffer, size_t capacity)>;
+
+// Allocator должен удовлетворять требованиям std::allocator_traits.
+// По умолчанию используется std::allocator, то есть глобальные operator new/operator delete
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Allocator::value_type must be the same as T");
+
 public:
+    using allocator_type = Allocator;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    VECTOR_CONSTEXPR explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    VECTOR_CONSTEXPR ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
     
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
-    RawMemory(RawMemory&& other) noexcept 
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , deleter_(std::exchange(other.deleter_, nullptr))
     {
-        Swap(other);
     }
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
+    // Аллокатор переходит вместе с памятью, только если этого требует
+    // propagate_on_container_move_assignment, иначе аллокаторы должны быть равны
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
-            Swap(rhs);
+            Deallocate(buffer_, capacity_);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(rhs.alloc_);
+            } else {
+                assert(alloc_ == rhs.alloc_);
+            }
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+            capacity_ = std::exchange(rhs.capacity_, 0);
+            deleter_ = std::exchange(rhs.deleter_, nullptr);
         }
         return *this;
     }
 
-    T* operator+(size_t offset) noexcept {
+    // Забирает блок вместе с его аллокатором, какими бы ни были propagate_on_container_*.
+    // Нужно копирующему присваиванию, когда аллокатор переходит по propagate_on_container_copy_assignment
+    VECTOR_CONSTEXPR void AssignWithAllocator(RawMemory&& rhs) noexcept {
+        if (this != &rhs) {
+            Deallocate(buffer_, capacity_);
+            alloc_ = rhs.alloc_;
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+            capacity_ = std::exchange(rhs.capacity_, 0);
+            deleter_ = std::exchange(rhs.deleter_, nullptr);
+        }
+    }
+
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap,
+    // иначе обмен допустим лишь между блоками с равными аллокаторами
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+        std::swap(deleter_, other.deleter_);
     }
 
-    const T* GetAddress() const noexcept {
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    VECTOR_CONSTEXPR T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    VECTOR_CONSTEXPR size_t Capacity() const {
         return capacity_;
     }
 
+    VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Изменяет вместимость блока, перенося содержимое побайтово. Доступно только
+    // для аллокаторов с методом reallocate; при исключении блок остаётся прежним
+    void Reallocate(size_t new_capacity) {
+        static_assert(HasReallocate<Allocator>::value, "Allocator does not support reallocate");
+        if (buffer_ == nullptr || new_capacity == 0) {
+            RawMemory new_data(new_capacity, alloc_);
+            Swap(new_data);
+        } else if (deleter_ != nullptr) {
+            // Чужой блок нельзя передать аллокатору: содержимое копируется в новый
+            RawMemory new_data(new_capacity, alloc_);
+            std::memcpy(static_cast<void*>(new_data.buffer_), static_cast<const void*>(buffer_),
+                        std::min(capacity_, new_capacity) * sizeof(T));
+            Swap(new_data);
+        } else {
+            buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+            VectorInstrumentation::OnDeallocate(capacity_ * sizeof(T));
+            VectorInstrumentation::OnAllocate(new_capacity * sizeof(T));
+            capacity_ = new_capacity;
+        }
+    }
+
+    // Увеличивает блок до new_capacity без перемещения элементов, если аллокатор это умеет
+    VECTOR_CONSTEXPR bool TryExpand([[maybe_unused]] size_t new_capacity) noexcept {
+        if constexpr (HasExpand<Allocator>::value) {
+            if (buffer_ != nullptr && deleter_ == nullptr && new_capacity > capacity_
+                && alloc_.expand(buffer_, capacity_, new_capacity)) {
+                VectorInstrumentation::OnDeallocate(capacity_ * sizeof(T));
+                VectorInstrumentation::OnAllocate(new_capacity * sizeof(T));
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Освобождает текущий блок и принимает во владение блок buffer, выделенный не аллокатором.
+    // Его память освободит deleter. При исключении владение buffer не передаётся
+    void Adopt(T* buffer, size_t capacity, BufferDeleter<T> deleter) {
+        auto* new_deleter = new BufferDeleter<T>(std::move(deleter));
+        Deallocate(buffer_, capacity_);
+        buffer_ = buffer;
+        capacity_ = capacity;
+        deleter_ = new_deleter;
+    }
+
+    // Отказывается от владения блоком, оставляя RawMemory пустым.
+    // Возвращает функцию, которой нужно освободить память блока
+    BufferDeleter<T> Release() {
+        BufferDeleter<T> deleter;
+        if (deleter_ != nullptr) {
+            deleter = std::move(*deleter_);
+            delete std::exchange(deleter_, nullptr);
+        } else if (buffer_ != nullptr) {
+            deleter = [alloc = alloc_](T* buffer, size_t capacity) mutable {
+                AllocTraits::deallocate(alloc, buffer, capacity);
+                VectorInstrumentation::OnDeallocate(capacity * sizeof(T));
+            };
+        }
+        buffer_ = nullptr;
+        capacity_ = 0;
+        return deleter;
+    }
+
 private:
+    Allocator alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+    // Функция освобождения блока, принятого через Adopt; nullptr, если блок выделен аллокатором
+    BufferDeleter<T>* deleter_ = nullptr;
     
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    VECTOR_CONSTEXPR T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = AllocTraits::allocate(alloc_, n);
+        VectorInstrumentation::OnAllocate(n * sizeof(T));
+        return buf;
+    }
+
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    VECTOR_CONSTEXPR void Deallocate(T* buf, size_t n) noexcept {
+        if (deleter_ != nullptr) {
+            (*deleter_)(buf, n);
+            delete std::exchange(deleter_, nullptr);
+        } else if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+            VectorInstrumentation::OnDeallocate(n * sizeof(T));
+        }
+    }
+};
+
+// Стратегии роста вместимости. NextCapacity возвращает новую вместимость не меньше required
+// для вектора текущей вместимости capacity с элементами размера element_size байт
+
+// Рост в 2 раза
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity * 2);
+    }
+};
+
+// Рост в Num/Den раз, например GrowthFactor<3, 2> для роста в 1.5 раза
+template <size_t Num, size_t Den>
+struct GrowthFactor {
+    static_assert(Num > Den && Den > 0, "Growth factor must be greater than 1");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max({required, capacity / Den * Num + capacity % Den * Num / Den, capacity + 1});
+    }
+};
+
+// Округляет вместимость, предложенную Base, вверх до размерного класса jemalloc:
+// 8, 16, далее шаг 16 байт до 128 и по 4 класса на каждую следующую степень двойки.
+// Память, которую аллокатор всё равно выделил бы под округление, достаётся элементам
+template <typename Base = GrowthFactor<3, 2>>
+struct SizeClassGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t bytes = Base::NextCapacity(capacity, required, element_size) * element_size;
+        return RoundToSizeClass(bytes) / element_size;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    static constexpr size_t RoundToSizeClass(size_t bytes) noexcept {
+        if (bytes <= 16) {
+            return bytes <= 8 ? 8 : 16;
+        }
+        size_t group = 16;
+        while (group * 2 < bytes) {
+            group *= 2;
+        }
+        const size_t step = std::max<size_t>(group / 4, 16);
+        return (bytes + step - 1) / step * step;
+    }
+};
+
+// Для блоков от PageSize байт округляет вместимость, предложенную Base, до целых страниц
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t new_capacity = Base::NextCapacity(capacity, required, element_size);
+        const size_t bytes = new_capacity * element_size;
+        if (bytes < PageSize) {
+            return new_capacity;
+        }
+        return (bytes + PageSize - 1) / PageSize * PageSize / element_size;
     }
 };
 
+// Участвует в перегрузке, только если It является хотя бы однопроходным итератором
+template <typename It>
+using RequireInputIterator = std::enable_if_t<std::is_convertible_v<
+    typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+// Тег для создания элементов инициализацией по умолчанию: тривиальные типы
+// остаются неинициализированными, без обнуления памяти
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag DEFAULT_INIT{};
+
+// Буфер, от владения которым вектор отказался через Release. Владелец уничтожает size элементов
+// и освобождает память вызовом deleter(data, capacity) либо передаёт буфер другому вектору через Adopt
 template <typename T>
+struct VectorBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    BufferDeleter<T> deleter;
+};
+
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DoublingGrowth>
 class Vector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+    using allocator_type = Allocator;
+
     Vector() = default;
 
-    explicit Vector(size_t size)
-        : data_(size)
+    VECTOR_CONSTEXPR explicit Vector(const Allocator& alloc) noexcept
+        : data_(alloc)
+    {
+    }
+
+    VECTOR_CONSTEXPR explicit Vector(size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
         , size_(size)  
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        UninitializedValueConstructN(data_.GetAddress(), size);
+    }
+    Vector(size_t size, DefaultInitTag, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+        , size_(size)
+    {
+        std::uninitialized_default_construct_n(data_.GetAddress(), size);
+    }
+    // Создаёт элементы параллельно. Если конструктор T выбросит исключение,
+    // все уже созданные элементы уничтожаются
+    Vector(size_t size, const ParallelPolicy& policy, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+    {
+        T* buffer = data_.GetAddress();
+        ParallelConstruct(size, policy, [buffer](size_t first, size_t last) {
+            std::uninitialized_value_construct(buffer + first, buffer + last);
+        }, [buffer](size_t first, size_t last) {
+            std::destroy(buffer + first, buffer + last);
+        });
+        size_ = size;
     }
-    Vector(const Vector& other)
-        : data_(other.size_)
+    VECTOR_CONSTEXPR Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+    }
+    Vector(const Vector& other, const ParallelPolicy& policy)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        const T* source = other.data_.GetAddress();
+        T* buffer = data_.GetAddress();
+        ParallelConstruct(other.size_, policy, [source, buffer](size_t first, size_t last) {
+            std::uninitialized_copy(source + first, source + last, buffer + first);
+        }, [buffer](size_t first, size_t last) {
+            std::destroy(buffer + first, buffer + last);
+        });
+        size_ = other.size_;
+    }
+    VECTOR_CONSTEXPR Vector(const Vector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
         , size_(other.size_) 
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+        UninitializedCopyN(other.data_.GetAddress(), other.size_, data_.GetAddress());
+    }
+    VECTOR_CONSTEXPR Vector(std::initializer_list<T> values, const Allocator& alloc = Allocator())
+        : data_(values.size(), alloc)
+        , size_(values.size())
+    {
+        UninitializedCopyN(values.begin(), values.size(), data_.GetAddress());
     }
     
-    ~Vector() {
+    VECTOR_CONSTEXPR ~Vector() {
         std::destroy_n(data_.GetAddress(), size_);
     }
     
-    Vector(Vector&& other) noexcept
+    VECTOR_CONSTEXPR Vector(Vector&& other) noexcept
             : data_(std::move(other.data_))
             , size_(other.size_)
     {
         other.size_ = 0;
     }
 
-    Vector& operator=(const Vector& rhs) {
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Память, выделенную старым аллокатором, нельзя переиспользовать. Swap не подходит:
+                    // без propagate_on_container_swap он требует равных аллокаторов
+                    Vector rhs_copy(rhs, rhs.GetAllocator());
+                    std::destroy_n(data_.GetAddress(), size_);
+                    data_.AssignWithAllocator(std::move(rhs_copy.data_));
+                    size_ = std::exchange(rhs_copy.size_, 0);
+                    return *this;
+                }
+            }
             if (rhs.size_ > data_.Capacity()) {
-                Vector rhs_copy(rhs);
+                Vector rhs_copy(rhs, GetAllocator());
                 Swap(rhs_copy);
             } else {
                 if (rhs.size_ < size_) {
@@ -126,109 +711,252 @@ public:
                 }
                 else {
                     std::copy_n(rhs.data_.GetAddress(), size_, data_.GetAddress());
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
+                    UninitializedCopyN(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
                 }
                 size_ = rhs.size_;
             }
         }
         return *this;
     }
-    Vector& operator=(Vector&& rhs) noexcept {
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
+            if constexpr (!AllocTraits::propagate_on_container_move_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                // Чужой буфер забрать нельзя: элементы перемещаются поштучно в свою память
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    MoveAssignElements(rhs);
+                    return *this;
+                }
+            }
+            std::destroy_n(data_.GetAddress(), size_);
             data_ = std::move(rhs.data_);
-            size_ = rhs.size_;
-            rhs.size_ = 0;
+            size_ = std::exchange(rhs.size_, 0);
         }
         return *this;
     }
 
-    void Swap(Vector& other) noexcept {
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
+
+    VECTOR_CONSTEXPR allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
     
-    size_t Size() const noexcept {
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
     
-    size_t Capacity() const noexcept {
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
         assert(index < size_);
         return data_[index];
     }
     
-    void Reserve(size_t new_capacity) {
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
+        if (new_capacity <= data_.Capacity()) {
+            return;
+        }
+        ChangeCapacity(new_capacity);
+    }
+
+    // Переносит элементы в новый блок параллельно, с теми же гарантиями, что и Reserve
+    void Reserve(size_t new_capacity, const ParallelPolicy& policy) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
-        RawMemory<T> new_data(new_capacity);
-        FullSafeMemoryTransfer(data_.GetAddress(), Size(), new_data, new_data.GetAddress());
+        if (data_.TryExpand(new_capacity)) {
+            return;
+        }
+        if constexpr (GROWS_IN_PLACE) {
+            ChangeCapacity(new_capacity);
+        } else {
+            RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+            T* source = begin();
+            T* buffer = new_data.GetAddress();
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                ParallelFor(Size(), policy, [source, buffer](size_t first, size_t last) {
+                    RelocateTrivially(source + first, last - first, buffer + first);
+                });
+            } else {
+                ParallelConstruct(Size(), policy, [this, source, buffer](size_t first, size_t last) {
+                    SafeMemoryTransfer(source + first, last - first, buffer + first);
+                }, [buffer](size_t first, size_t last) {
+                    std::destroy(buffer + first, buffer + last);
+                });
+                DestroyElements(policy);
+            }
+            RecordReallocation(Capacity(), new_data.Capacity());
+            data_.Swap(new_data);
+        }
+    }
+
+    // Уменьшает вместимость до размера, возвращая лишнюю память аллокатору
+    VECTOR_CONSTEXPR void ShrinkToFit() {
+        if (Capacity() > Size()) {
+            ChangeCapacity(Size());
+        }
+    }
+
+    // Удаляет все элементы. Вместимость сохраняется, если не запрошено освобождение памяти
+    VECTOR_CONSTEXPR void Clear(bool release_capacity = false) noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+        if (release_capacity) {
+            data_ = RawMemory<T, Allocator>(GetAllocator());
+        }
+    }
+
+    // Уничтожает элементы параллельно. Деструктор Vector работает в одном потоке,
+    // поэтому очень большие векторы стоит очищать так перед уничтожением
+    void Clear(const ParallelPolicy& policy, bool release_capacity = false) noexcept {
+        DestroyElements(policy);
+        size_ = 0;
+        Clear(release_capacity);
+    }
+
+    // Объём памяти в байтах, удерживаемой вектором под элементы
+    VECTOR_CONSTEXPR size_t BytesAllocated() const noexcept {
+        return Capacity() * sizeof(T);
+    }
+
+    // Указатель на первый элемент; вместе с Size() задаёт непрерывный диапазон, из которого
+    // в C++20 строится std::span
+    VECTOR_CONSTEXPR T* Data() noexcept {
+        return data_.GetAddress();
+    }
+
+    VECTOR_CONSTEXPR const T* Data() const noexcept {
+        return data_.GetAddress();
+    }
+
+    // Принимает во владение буфер buffer вместимостью capacity, в начале которого уже созданы
+    // size элементов, и уничтожает текущие элементы. Элементы не копируются. Когда буфер станет
+    // не нужен (при уничтожении вектора, росте, ShrinkToFit или Clear(true)), вектор уничтожит
+    // свои элементы и вызовет копируемый deleter(buffer, capacity). При исключении буфер остаётся
+    // у вызывающего
+    template <typename Deleter>
+    void Adopt(T* buffer, size_t size, size_t capacity, Deleter deleter) {
+        assert(size <= capacity);
+        RawMemory<T, Allocator> adopted(GetAllocator());
+        adopted.Adopt(buffer, capacity, std::move(deleter));
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.Swap(adopted);
+        size_ = size;
+    }
+
+    // Отказывается от владения буфером, не уничтожая элементы, и становится пустым
+    VectorBuffer<T> Release() {
+        VectorBuffer<T> buffer{data_.GetAddress(), size_, Capacity(), data_.Release()};
+        size_ = 0;
+        return buffer;
     }
     
-    void Resize(size_t new_size) {
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
         if (new_size < size_) {
             std::destroy_n(data_.GetAddress() + new_size, Size() - new_size);
         } 
         else if (new_size > size_) {
-            size_t capacity = Size() == 0 ? 1 : Capacity();
-            while (new_size > Capacity()) {
-                Reserve(capacity * 2);
+            if (new_size > Capacity()) {
+                Reserve(NextCapacity(new_size));
             }
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
         }
         size_ = new_size;
     }
+
+    // Как Resize, но новые элементы инициализируются по умолчанию: память под тривиальные
+    // типы не обнуляется, если её всё равно предстоит перезаписать
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, Size() - new_size);
+        } 
+        else if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(NextCapacity(new_size));
+            }
+            std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Аналог std::string::resize_and_overwrite: увеличивает размер до new_size без обнуления
+    // новых элементов и вызывает op(data, new_size), который заполняет буфер и возвращает
+    // итоговый размер не больше new_size. Первые min(Size(), new_size) элементов сохраняются
+    template <typename Operation>
+    void ResizeAndOverwrite(size_t new_size, Operation op) {
+        ResizeDefaultInit(new_size);
+        const size_t result_size = std::move(op)(data_.GetAddress(), new_size);
+        assert(result_size <= new_size);
+        std::destroy_n(data_.GetAddress() + result_size, new_size - result_size);
+        size_ = result_size;
+    }
     
     template <typename F> // Forwarding reference
-    void PushBack(F&& value) {
+    VECTOR_CONSTEXPR void PushBack(F&& value) {
         EmplaceBack(std::forward<F>(value));
     }
     
-    void PopBack() /* noexcept */ {
-        std::destroy_at(data_.GetAddress() + size_);
+    VECTOR_CONSTEXPR void PopBack() /* noexcept */ {
+        assert(size_ > 0);
+        std::destroy_at(data_.GetAddress() + size_ - 1);
         --size_;
     }
     
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
+        ExpandIfFull(Size() + 1);
         if (Size() < Capacity()) {
-            new (data_ + Size()) T(std::forward<Args>(args)...);          
+            ConstructAt(data_ + Size(), std::forward<Args>(args)...);
+        }
+        else if constexpr (GROWS_IN_PLACE) {
+            alignas(T) unsigned char buffer[sizeof(T)];
+            T* value = GrowInPlace(NextCapacity(Size() + 1), buffer, std::forward<Args>(args)...);
+            RelocateTrivially(value, 1, data_ + Size());
         }
         else {
-            RawMemory<T> new_data(size_ == 0 ? 1 : Capacity() * 2);
-            new (new_data + Size()) T(std::forward<Args>(args)...);
-            FullSafeMemoryTransfer(data_.GetAddress(), Size(), new_data, new_data.GetAddress());
+            RawMemory<T, Allocator> new_data(NextCapacity(Size() + 1), GetAllocator());
+            ConstructAt(new_data + Size(), std::forward<Args>(args)...);
+            TransferAroundGap(Size(), 1, new_data);
         }
         ++size_;
         return data_[size_ - 1];
     }
+
+    // Добавляет элементы диапазона [first, last) в конец вектора
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last) {
+        Insert(cend(), first, last);
+    }
     
     using iterator = T*;
     using const_iterator = const T*;
     
-    iterator begin() noexcept {
+    VECTOR_CONSTEXPR iterator begin() noexcept {
         return data_.GetAddress();
     }
-    iterator end() noexcept {
+    VECTOR_CONSTEXPR iterator end() noexcept {
         return data_.GetAddress() + Size();
     }
-    const_iterator begin() const noexcept {
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept {
         return data_.GetAddress();
     }
-    const_iterator end() const noexcept {
+    VECTOR_CONSTEXPR const_iterator end() const noexcept {
         return data_.GetAddress() + Size();
     }
-    const_iterator cbegin() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
         return data_.GetAddress();
     }
-    const_iterator cend() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept {
         return data_.GetAddress() + Size();
     }
 
@@ -236,30 +964,39 @@ public:
     iterator Emplace(const_iterator pos, Args&&... args) {
         assert(pos >= cbegin() && pos <= cend());
         size_t pos_ind = pos - cbegin();
-        if (Size() < Capacity()) {
-            new (end()) T(std::forward<T>(*(end() - 1)));
-            std::move_backward(begin() + pos_ind, end() - 1, end());
-            data_[pos_ind] = T(std::forward<Args>(args)...);
+        ExpandIfFull(Size() + 1);
+        if (Size() < Capacity() && pos_ind == Size()) {
+            new (end()) T(std::forward<Args>(args)...);
+        }
+        else if (Size() < Capacity()) {
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                // Аргументы могут ссылаться на элементы вектора, поэтому объект
+                // создаётся до сдвига хвоста и переносится на место побайтово
+                alignas(T) unsigned char buffer[sizeof(T)];
+                T* value = new (buffer) T(std::forward<Args>(args)...);
+                RelocateTrivially(begin() + pos_ind, Size() - pos_ind, begin() + pos_ind + 1);
+                RelocateTrivially(value, 1, begin() + pos_ind);
+            } else if constexpr (IS_SINGLE_VALUE<Args...>) {
+                // Размер уже увеличен в ShiftTailRight
+                AssignShifted(pos_ind, std::forward<Args>(args)...);
+                return begin() + pos_ind;
+            } else {
+                T value(std::forward<Args>(args)...);
+                ShiftTailRight(pos_ind);
+                data_[pos_ind] = std::move(value);
+                return begin() + pos_ind;
+            }
+        }
+        else if constexpr (GROWS_IN_PLACE) {
+            alignas(T) unsigned char buffer[sizeof(T)];
+            T* value = GrowInPlace(NextCapacity(Size() + 1), buffer, std::forward<Args>(args)...);
+            RelocateTrivially(begin() + pos_ind, Size() - pos_ind, begin() + pos_ind + 1);
+            RelocateTrivially(value, 1, begin() + pos_ind);
         }
         else {
-            RawMemory<T> new_data(Size() == 0 ? 1 : Capacity() * 2);
+            RawMemory<T, Allocator> new_data(NextCapacity(Size() + 1), GetAllocator());
             new (new_data.GetAddress() + pos_ind) T(std::forward<Args>(args)...);
-            try {
-                SafeMemoryTransfer(begin(), pos_ind, new_data.GetAddress());
-            }
-            catch (...) {
-                std::destroy_at(new_data.GetAddress() + pos_ind);
-                throw;
-            }
-            try {
-                SafeMemoryTransfer(begin() + pos_ind, end() - begin() - pos_ind, new_data.GetAddress() + pos_ind + 1);
-            }
-            catch (...) {
-                std::destroy_n(new_data.GetAddress(), pos_ind + 1);
-                throw;
-            }
-            std::destroy_n(begin(), Size());
-            data_.Swap(new_data);
+            TransferAroundGap(pos_ind, 1, new_data);
         }
         ++size_;
         return begin() + pos_ind;
@@ -268,8 +1005,52 @@ public:
     iterator Erase(const_iterator pos) /*noexcept(std::is_nothrow_move_assignable_v<T>)*/ {
         assert(pos >= cbegin() && pos < cend());
         size_t i = pos - cbegin();
-        std::move(begin() + i + 1, end(), begin() + i);
-        std::destroy_at(data_.GetAddress() + Size() - 1);
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            std::destroy_at(data_.GetAddress() + i);
+            RelocateTrivially(begin() + i + 1, Size() - i - 1, begin() + i);
+        } else {
+            std::move(begin() + i + 1, end(), begin() + i);
+            std::destroy_at(data_.GetAddress() + Size() - 1);
+        }
+        --size_;
+        return begin() + i;
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t i = first - cbegin();
+        const size_t count = last - first;
+        if (count == 0) {
+            return begin() + i;
+        }
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            std::destroy_n(begin() + i, count);
+            RelocateTrivially(begin() + i + count, Size() - i - count, begin() + i);
+        } else {
+            std::move(begin() + i + count, end(), begin() + i);
+            std::destroy_n(end() - count, count);
+        }
+        size_ -= count;
+        return begin() + i;
+    }
+
+    // Удаляет элемент за O(1), перенося на его место последний элемент. Порядок не сохраняется
+    iterator SwapErase(const_iterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        const size_t i = pos - cbegin();
+        T* last = end() - 1;
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            std::destroy_at(begin() + i);
+            if (begin() + i != last) {
+                RelocateTrivially(last, 1, begin() + i);
+            }
+        } else {
+            if (begin() + i != last) {
+                begin()[i] = std::move(*last);
+            }
+            std::destroy_at(last);
+        }
         --size_;
         return begin() + i;
     }
@@ -279,22 +1060,299 @@ public:
         return Emplace(pos, std::forward<F>(value));
     }
 
+    // Вставляет count копий value перед pos, сдвигая хвост не более одного раза
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(pos >= cbegin() && pos <= cend());
+        size_t pos_ind = pos - cbegin();
+        ExpandIfFull(Size() + count);
+        if (count == 0 || Size() + count > Capacity()) {
+            return InsertRange(pos_ind, RepeatIterator(&value), count);
+        }
+        // value может ссылаться на элемент вектора, который сдвинется вместе с хвостом
+        const T value_copy(value);
+        return InsertRange(pos_ind, RepeatIterator(&value_copy), count);
+    }
+
+    // Вставляет элементы диапазона [first, last) перед pos. Для многопроходных итераторов
+    // размер вычисляется заранее: память выделяется не более одного раза, хвост сдвигается один раз.
+    // Диапазон не должен ссылаться на элементы самого вектора
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        assert(pos >= cbegin() && pos <= cend());
+        size_t pos_ind = pos - cbegin();
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_convertible_v<Category, std::forward_iterator_tag>) {
+            return InsertRange(pos_ind, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            const size_t old_size = Size();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + pos_ind, begin() + old_size, end());
+            return begin() + pos_ind;
+        }
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+protected:
+    // Переносит элементы в блок вместимостью ровно new_capacity, не меньшей размера
+    VECTOR_CONSTEXPR void ChangeCapacity(size_t new_capacity) {
+        assert(new_capacity >= Size());
+        if (data_.TryExpand(new_capacity)) {
+            return;
+        }
+        if constexpr (GROWS_IN_PLACE) {
+            const size_t old_capacity = Capacity();
+            data_.Reallocate(new_capacity);
+            RecordReallocation(old_capacity, new_capacity);
+        } else {
+            RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+            FullSafeMemoryTransfer(data_.GetAddress(), Size(), new_data, new_data.GetAddress());
+        }
+    }
+
 private:
-    RawMemory<T> data_;
+    // Блок растёт через RawMemory::Reallocate: на месте или побайтовым переносом
+    static constexpr bool GROWS_IN_PLACE = IsTriviallyRelocatable<T>::value && HasReallocate<Allocator>::value;
+
+    // Элементы переносятся в новый блок перемещением, а не копированием
+    static constexpr bool RELOCATES_BY_MOVE = RelocatesByMove<T>::value;
+
+    static constexpr RelocationKind RELOCATION_KIND = RELOCATION_KIND_OF<T>;
+
+    RawMemory<T, Allocator> data_;
     size_t size_ = 0;
+
+    // Вместимость, до которой нужно вырасти, чтобы поместилось required элементов
+    VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    // Если required элементов не помещается, пытается расширить блок на месте. Элементы при этом
+    // не перемещаются, так что ссылки на них, в том числе из аргументов вставки, остаются верными
+    VECTOR_CONSTEXPR void ExpandIfFull(size_t required) noexcept {
+        if (required > Capacity()) {
+            data_.TryExpand(NextCapacity(required));
+        }
+    }
+
+    // Аргументы Emplace состоят из одного значения типа T
+    template <typename... Args>
+    static constexpr bool IS_SINGLE_VALUE = sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, T> && ...);
+
+    // Сдвигает элементы [pos_ind, Size()) на одну позицию вправо в пределах вместимости.
+    // Размер увеличивается, как только создан новый последний элемент: если сдвиг или
+    // последующее присваивание выбросит исключение, деструктор вектора уничтожит и его
+    void ShiftTailRight(size_t pos_ind) {
+        new (end()) T(std::move(*(end() - 1)));
+        ++size_;
+        std::move_backward(begin() + pos_ind, end() - 2, end() - 1);
+    }
+
+    // Сдвигает хвост и присваивает value освободившейся позиции pos_ind без временного объекта.
+    // Если value ссылается на сдвигаемый элемент вектора, значение берётся с его нового места.
+    // Rvalue-аргумент, как и в std::vector, считается не ссылающимся на элементы вектора
+    template <typename U>
+    void AssignShifted(size_t pos_ind, U&& value) {
+        if constexpr (std::is_lvalue_reference_v<U>) {
+            const T* source = std::addressof(value);
+            const std::less<const T*> less;
+            if (!less(source, begin() + pos_ind) && less(source, end())) {
+                ++source;
+            }
+            ShiftTailRight(pos_ind);
+            data_[pos_ind] = *source;
+        } else {
+            ShiftTailRight(pos_ind);
+            data_[pos_ind] = std::move(value);
+        }
+    }
+
+    // Параллельно уничтожает элементы, не меняя размер
+    void DestroyElements(const ParallelPolicy& policy) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            T* buffer = begin();
+            ParallelFor(Size(), policy, [buffer](size_t first, size_t last) {
+                std::destroy(buffer + first, buffer + last);
+            });
+        }
+    }
+
+    // Сообщает инструментированию о переносе Size() элементов в блок вместимости new_capacity
+    VECTOR_CONSTEXPR void RecordReallocation([[maybe_unused]] size_t old_capacity, [[maybe_unused]] size_t new_capacity) const noexcept {
+#if defined(VECTOR_ENABLE_STATS)
+        VectorInstrumentation::OnReallocation({this, sizeof(T), old_capacity, new_capacity, Size(), RELOCATION_KIND});
+#endif
+    }
+
+    // Создаёт новый элемент в buffer и затем расширяет блок до new_capacity. Элемент создаётся
+    // заранее, так как аргументы могут ссылаться на элементы вектора в старом блоке
+    template <typename... Args>
+    T* GrowInPlace(size_t new_capacity, unsigned char* buffer, Args&&... args) {
+        T* value = new (buffer) T(std::forward<Args>(args)...);
+        const size_t old_capacity = Capacity();
+        try {
+            data_.Reallocate(new_capacity);
+        }
+        catch (...) {
+            std::destroy_at(value);
+            throw;
+        }
+        RecordReallocation(old_capacity, new_capacity);
+        return value;
+    }
     
-    void FullSafeMemoryTransfer(iterator begin, size_t size, RawMemory<T>& new_data, T* new_address_begin) {
-        SafeMemoryTransfer(begin, size, new_address_begin);
-        std::destroy_n(begin, size);
+    // Перемещающее присваивание при неравных аллокаторах, не распространяемых при перемещении
+    void MoveAssignElements(Vector& rhs) {
+        if (rhs.size_ > data_.Capacity()) {
+            RawMemory<T, Allocator> new_data(rhs.size_, GetAllocator());
+            std::uninitialized_move_n(rhs.data_.GetAddress(), rhs.size_, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
+        } else if (rhs.size_ < size_) {
+            std::move(rhs.begin(), rhs.end(), begin());
+            std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
+        } else {
+            std::move(rhs.begin(), rhs.begin() + size_, begin());
+            std::uninitialized_move_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
+        }
+        size_ = rhs.size_;
+        std::destroy_n(rhs.data_.GetAddress(), rhs.size_);
+        rhs.size_ = 0;
+    }
+
+    // Итератор по одному и тому же значению, позволяющий вставлять count копий через InsertRange
+    class RepeatIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        explicit RepeatIterator(const T* value) noexcept
+            : value_(value) {
+        }
+        reference operator*() const noexcept {
+            return *value_;
+        }
+        RepeatIterator& operator++() noexcept {
+            return *this;
+        }
+        RepeatIterator operator++(int) noexcept {
+            return *this;
+        }
+
+    private:
+        const T* value_;
+    };
+
+    // Вставляет count элементов, создаваемых из [first, first + count), в позицию pos_ind
+    template <typename ForwardIt>
+    iterator InsertRange(size_t pos_ind, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return begin() + pos_ind;
+        }
+        ExpandIfFull(Size() + count);
+        if (Size() + count > Capacity()) {
+            RawMemory<T, Allocator> new_data(NextCapacity(Size() + count), GetAllocator());
+            std::uninitialized_copy_n(first, count, new_data.GetAddress() + pos_ind);
+            TransferAroundGap(pos_ind, count, new_data);
+            size_ += count;
+        } else if constexpr (IsTriviallyRelocatable<T>::value) {
+            T* pos = begin() + pos_ind;
+            const size_t elems_after = Size() - pos_ind;
+            RelocateTrivially(pos, elems_after, pos + count);
+            try {
+                std::uninitialized_copy_n(first, count, pos);
+            }
+            catch (...) {
+                RelocateTrivially(pos + count, elems_after, pos);
+                throw;
+            }
+            size_ += count;
+        } else {
+            // Размер увеличивается после каждого шага, чтобы при исключении
+            // вектор оставался в согласованном состоянии
+            T* pos = begin() + pos_ind;
+            T* old_end = end();
+            const size_t elems_after = Size() - pos_ind;
+            if (elems_after > count) {
+                std::uninitialized_move(old_end - count, old_end, old_end);
+                size_ += count;
+                std::move_backward(pos, old_end - count, old_end);
+                std::copy_n(first, count, pos);
+            } else {
+                ForwardIt mid = std::next(first, elems_after);
+                std::uninitialized_copy_n(mid, count - elems_after, old_end);
+                size_ += count - elems_after;
+                std::uninitialized_move(pos, old_end, pos + count);
+                size_ += elems_after;
+                std::copy_n(first, elems_after, pos);
+            }
+        }
+        return begin() + pos_ind;
+    }
+
+    // Переносит элементы в new_data, оставляя после первых pos_ind из них промежуток
+    // из gap уже созданных элементов, и делает new_data текущим блоком.
+    // При исключении элементы промежутка уничтожаются, а вектор остаётся прежним
+    VECTOR_CONSTEXPR void TransferAroundGap(size_t pos_ind, size_t gap, RawMemory<T, Allocator>& new_data) {
+        T* new_begin = new_data.GetAddress();
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            RelocateTrivially(begin(), pos_ind, new_begin);
+            RelocateTrivially(begin() + pos_ind, Size() - pos_ind, new_begin + pos_ind + gap);
+        } else {
+            try {
+                SafeMemoryTransfer(begin(), pos_ind, new_begin);
+            }
+            catch (...) {
+                std::destroy_n(new_begin + pos_ind, gap);
+                throw;
+            }
+            try {
+                SafeMemoryTransfer(begin() + pos_ind, Size() - pos_ind, new_begin + pos_ind + gap);
+            }
+            catch (...) {
+                std::destroy_n(new_begin, pos_ind + gap);
+                throw;
+            }
+            std::destroy_n(begin(), Size());
+        }
+        RecordReallocation(Capacity(), new_data.Capacity());
+        data_.Swap(new_data);
+    }
+
+    VECTOR_CONSTEXPR void FullSafeMemoryTransfer(iterator begin, size_t size, RawMemory<T, Allocator>& new_data, T* new_address_begin) {
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            RelocateTrivially(begin, size, new_address_begin);
+        } else {
+            SafeMemoryTransfer(begin, size, new_address_begin);
+            std::destroy_n(begin, size);
+        }
+        RecordReallocation(Capacity(), new_data.Capacity());
         data_.Swap(new_data);
     }
     
-    void SafeMemoryTransfer(iterator begin, size_t size, T* new_address_begin) {
+    VECTOR_CONSTEXPR void SafeMemoryTransfer(iterator begin, size_t size, T* new_address_begin) {
         // constexpr оператор if будет вычислен во время компиляции
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(begin, size, new_address_begin);
+        if constexpr (RELOCATES_BY_MOVE) {
+            UninitializedMoveN(begin, size, new_address_begin);
         } else {
-            std::uninitialized_copy_n(begin, size, new_address_begin);
+            UninitializedCopyForRelocation(begin, size, new_address_begin);
         }
     }
 };
+
+// Удаляет все элементы, для которых pred возвращает true, за один проход.
+// Возвращает количество удалённых элементов
+template <typename T, typename Allocator, typename Growth, typename Predicate>
+size_t EraseIf(Vector<T, Allocator, Growth>& vector, Predicate pred) {
+    auto new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t count = vector.end() - new_end;
+    vector.Erase(new_end, vector.end());
+    return count;
+}